@@ -856,9 +856,12 @@ void Animation<T>::drawGraphicalObjects(glm::vec3 view)
     bounding_box.draw();
   }
 
-  // Draw point clouds
+  // Draw point clouds, the number of agents of a class can change
   for (int i=0; i<point_clouds.size(); i++){
-    point_clouds[i].setPoints(simulation.getAgentClassPointer(i));
+    int num_points;
+    T* pointer = simulation.getAgentClassPositions(i, num_points);
+    point_clouds[i].setPoints(pointer);
+    point_clouds[i].setNumPoints(num_points);
     point_clouds[i].update();
     point_clouds[i].draw();
   }
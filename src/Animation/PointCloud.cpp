@@ -137,13 +137,6 @@ void PointCloud<T>::init(
   std::cout << "PointCloud::init: \
     Initializing the point cloud" << std::endl;
 #endif
-  // Little hack to avoid errors when data type is double
-  // avoids all drawing of points
-  if (std::is_same<T, double>::value)
-  {
-    num_points = 0; 
-  }
-
   // Set window
   setWindow(window);
 
@@ -347,6 +340,13 @@ T* PointCloud<T>::getPoints()
 template <typename T>
 void PointCloud<T>::setNumPoints(int num_points)
 {
+  // Little hack to avoid errors when data type is double
+  // avoids all drawing of points
+  if (std::is_same<T, double>::value)
+  {
+    num_points = 0; 
+  }
+
   this->num_points = num_points;
 }
 
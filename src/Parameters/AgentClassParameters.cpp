@@ -15,6 +15,9 @@ AgentClassParameters<T>::AgentClassParameters()
     movespeed_approach_food(0.0),
     status(0),
     num_agents(0),
+    max_agents(0),
+    reproduction_energy(0.0),
+    respawn(true),
     audibility(0.0),
     mu_energy(0.0),
     sigma_energy(0.0),
@@ -79,6 +82,9 @@ AgentClassParameters<T>::AgentClassParameters(
       movespeed_approach_food(movespeed_approach_food),
       status(status),
       num_agents(num_agents),
+      max_agents(0),
+      reproduction_energy(0.0),
+      respawn(true),
       audibility(audibility),
       mu_energy(mu_energy),
       sigma_energy(sigma_energy),
@@ -199,6 +205,11 @@ AgentClassParameters<T>& AgentClassParameters<T>::operator=(
   // Set the number of agents
   num_agents = c.num_agents;
 
+  // Set the population dynamics
+  max_agents = c.max_agents;
+  reproduction_energy = c.reproduction_energy;
+  respawn = c.respawn;
+
   // Set the start and stop index
   start_index = c.start_index;
   stop_index = c.stop_index;
@@ -333,6 +344,18 @@ void AgentClassParameters<T>::load(std::string filename)
       setNumAgents(config[key]["num_agents"].value_or(0));
     }
 
+    if (entry.second.as_table()->contains("max_agents")) {
+      setMaxAgents(config[key]["max_agents"].value_or(0));
+    }
+
+    if (entry.second.as_table()->contains("reproduction_energy")) {
+      setReproductionEnergy(config[key]["reproduction_energy"].value_or(0.0));
+    }
+
+    if (entry.second.as_table()->contains("respawn")) {
+      setRespawn(config[key]["respawn"].value_or(true));
+    }
+
     if (entry.second.as_table()->contains("strategy")) {
       setStrategy(config[key]["strategy"].value_or(0));
     }
@@ -476,6 +499,9 @@ void AgentClassParameters<T>::print(std::ostream& stream) const
   stream << "  strategy = " << strategy << std::endl;
   stream << "  status = " << status << std::endl;
   stream << "  num_agents = " << num_agents << std::endl;
+  stream << "  max_agents = " << max_agents << std::endl;
+  stream << "  reproduction_energy = " << reproduction_energy << std::endl;
+  stream << "  respawn = " << (respawn ? "true" : "false") << std::endl;
   stream << "  audibility = " << audibility << std::endl;
   stream << "  mu_energy = " << mu_energy << std::endl;
   stream << "  sigma_energy = " << sigma_energy << std::endl;
@@ -868,6 +894,87 @@ int AgentClassParameters<T>::getNumAgents() const
   return num_agents;
 }
 
+template <typename T>
+void AgentClassParameters<T>::setMaxAgents(int max_agents)
+{
+#ifdef DEBUG
+  std::cout << "AgentClassParameters::setMaxAgents: \
+    Set the largest number of agents in the agent class to:" 
+      << max_agents << std::endl;
+#endif
+
+  this->max_agents = max_agents;
+}
+
+template <typename T>
+int AgentClassParameters<T>::getMaxAgents() const
+{
+#ifdef DEBUG
+  /*
+  std::cout << "AgentClassParameters::getMaxAgents: \
+    Get the largest number of agents in the agent class" << std::endl;
+    */
+#endif
+  
+  return max_agents;
+}
+
+template <typename T>
+int AgentClassParameters<T>::getCapacity() const
+{
+  return std::max(num_agents, max_agents);
+}
+
+template <typename T>
+void AgentClassParameters<T>::setReproductionEnergy(T reproduction_energy)
+{
+#ifdef DEBUG
+  std::cout << "AgentClassParameters::setReproductionEnergy: \
+    Set the reproduction energy of the agent class to:" 
+      << reproduction_energy << std::endl;
+#endif
+
+  this->reproduction_energy = reproduction_energy;
+}
+
+template <typename T>
+T AgentClassParameters<T>::getReproductionEnergy() const
+{
+#ifdef DEBUG
+  /*
+  std::cout << "AgentClassParameters::getReproductionEnergy: \
+    Get the reproduction energy of the agent class" << std::endl;
+    */
+#endif
+
+  return reproduction_energy;
+}
+
+template <typename T>
+void AgentClassParameters<T>::setRespawn(bool respawn)
+{
+#ifdef DEBUG
+  std::cout << "AgentClassParameters::setRespawn: \
+    Set the respawn flag of the agent class to:" 
+      << respawn << std::endl;
+#endif
+
+  this->respawn = respawn;
+}
+
+template <typename T>
+bool AgentClassParameters<T>::getRespawn() const
+{
+#ifdef DEBUG
+  /*
+  std::cout << "AgentClassParameters::getRespawn: \
+    Get the respawn flag of the agent class" << std::endl;
+    */
+#endif
+
+  return respawn;
+}
+
 template <typename T>
 void AgentClassParameters<T>::setAudibility(T audibility)
 {
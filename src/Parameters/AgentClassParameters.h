@@ -1,6 +1,7 @@
 #ifndef AGENT_CLASS_PARAMETERS_H
 #define AGENT_CLASS_PARAMETERS_H
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <string>
@@ -132,6 +133,22 @@ struct AgentClassParameters
   void setNumAgents(int num_agents);
   int getNumAgents() const;
 
+  // Largest number of agents, 0 for the initial number of agents
+  void setMaxAgents(int max_agents);
+  int getMaxAgents() const;
+
+  // Number of slots of the class in the state, the larger of the
+  // initial and the largest number of agents
+  int getCapacity() const;
+
+  // Energy at which an agent splits into two, 0 for no reproduction
+  void setReproductionEnergy(T reproduction_energy);
+  T getReproductionEnergy() const;
+
+  // Respawn dead agents, else their slots are freed
+  void setRespawn(bool respawn);
+  bool getRespawn() const;
+
   // Audibility
   void setAudibility(T audibility);
   T getAudibility() const;
@@ -220,7 +237,16 @@ struct AgentClassParameters
   // number of agents
   int num_agents;
 
-  // global start and stop index of the agents
+  // largest number of agents, 0 for num_agents
+  int max_agents;
+
+  // energy at which an agent splits into two, 0 for no reproduction
+  T reproduction_energy;
+
+  // respawn dead agents, else their slots are freed
+  bool respawn;
+
+  // global start and stop index of the slots of the agents
   int start_index;
   int stop_index;
 
@@ -391,6 +391,18 @@ class AgentClassParametersImGuiHandle
       agent_class_params_new.setNumAgents(num_agents);
     }
 
+    // Set the largest number of agents
+    int max_agents = agent_class_params_new.getMaxAgents();
+    if (ImGui::InputInt("Largest number of agents", &max_agents)){
+      agent_class_params_new.setMaxAgents(max_agents);
+    }
+
+    // Set the respawn flag
+    bool respawn = agent_class_params_new.getRespawn();
+    if (ImGui::Checkbox("Respawn", &respawn)){
+      agent_class_params_new.setRespawn(respawn);
+    }
+
     // Set the strategy
     int strategy = agent_class_params_new.getStrategy();
     if (ImGui::InputInt("Strategy", &strategy)){
@@ -467,6 +479,13 @@ class AgentClassParametersImGuiHandle
       agent_class_params_new.setEnergyUptakeRate(energy_uptake_rate);
     }
 
+    // Set the reproduction energy
+    T reproduction_energy = agent_class_params_new.getReproductionEnergy();
+    if (ImGui::InputScalar("Reproduction energy", 
+          ImGuiDataType_Float, &reproduction_energy)){
+      agent_class_params_new.setReproductionEnergy(reproduction_energy);
+    }
+
     // Separator
     ImGui::SeparatorText("Individual movement parameters\n are a fraction of the maximal movespeed");
 
@@ -11,15 +11,17 @@ GlobalParameters<T>::GlobalParameters(int argc, char **argv,
 #ifdef ANIMATION
   ap(a),
 #endif
-  run_counter(0),
   gui_flag(false),
   verbosity(0),
   log_level(0),
-  output_precision(6),
+  run_counter(0),
   time_string("yyyy-mm-ddThh-mm-ssZ"),
   basename_output("output"),
   runtime_directory("output"),
-  run_directory("output")
+  run_directory("output"),
+  output_precision(6),
+  scaling_study_flag(false),
+  scaling_iterations(100)
 {
   // Set output precision
   std::cout.precision(output_precision);
@@ -109,6 +111,21 @@ void GlobalParameters<T>::parseCommandLineArguments(int argc, char **argv)
     // Log level
     ("l,log-level", "Log level", cxxopts::value<int>()->default_value("0"))
 
+    // Scaling study
+    ("scaling-study", "Run a scaling study instead of the simulation")
+
+    // Thread counts of the scaling study
+    ("scaling-threads", "Thread counts of the scaling study", 
+        cxxopts::value<std::vector<int>>()->default_value("1,2,4,8"))
+
+    // Agent multipliers of the scaling study
+    ("scaling-agents", "Agent multipliers of the scaling study", 
+        cxxopts::value<std::vector<float>>()->default_value("1,2,4"))
+
+    // Iterations per configuration of the scaling study
+    ("scaling-iterations", "Iterations per scaling study configuration", 
+        cxxopts::value<int>()->default_value("100"))
+
     // Version
     ("version", "Print version");
 
@@ -137,6 +154,21 @@ void GlobalParameters<T>::parseCommandLineArguments(int argc, char **argv)
   // Get log level
   log_level = result["log-level"].as<int>();
 
+  // Get scaling study settings
+  if (result.count("scaling-study")){
+    scaling_study_flag = true;
+  }
+  scaling_threads = result["scaling-threads"].as<std::vector<int>>();
+  for (float m : result["scaling-agents"].as<std::vector<float>>()){
+    scaling_multipliers.push_back(m);
+  }
+  scaling_iterations = result["scaling-iterations"].as<int>();
+  if (scaling_iterations < 1){
+    handleError("Scaling study needs at least one iteration, using 1", 
+        WARNING);
+    scaling_iterations = 1;
+  }
+
   // Get verbosity level
   verbosity = result["verbose"].as<int>();
 
@@ -279,6 +311,11 @@ void GlobalParameters<T>::initRunDirectory()
 
   // Initialize run directory name
   initRunDirectoryName();
+
+  // The scaling study only writes its report to the runtime directory
+  if (scaling_study_flag) {
+    return;
+  }
   
   // If runtime directory exists, create run directory
   if (std::filesystem::exists(run_directory) == false) {
@@ -408,6 +445,30 @@ bool GlobalParameters<T>::getGuiFlag() const
   return gui_flag;
 }
 
+template <typename T>
+bool GlobalParameters<T>::getScalingStudyFlag() const
+{
+  return scaling_study_flag;
+}
+
+template <typename T>
+const std::vector<int> &GlobalParameters<T>::getScalingThreads() const
+{
+  return scaling_threads;
+}
+
+template <typename T>
+const std::vector<T> &GlobalParameters<T>::getScalingMultipliers() const
+{
+  return scaling_multipliers;
+}
+
+template <typename T>
+int GlobalParameters<T>::getScalingIterations() const
+{
+  return scaling_iterations;
+}
+
 template <typename T>
 SimulationParameters<T> &GlobalParameters<T>::getSimulationParameters() 
 {
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <iomanip>
 #include <filesystem>
+#include <vector>
 
 
 // Command line option parser
@@ -83,6 +84,12 @@ class GlobalParameters
   // Get the GUI flag
   bool getGuiFlag() const;
 
+  // Get the scaling study settings
+  bool getScalingStudyFlag() const;
+  const std::vector<int> &getScalingThreads() const;
+  const std::vector<T> &getScalingMultipliers() const;
+  int getScalingIterations() const;
+
   // Get simulation parameters
   SimulationParameters<T> &getSimulationParameters();
 
@@ -149,6 +156,16 @@ class GlobalParameters
   // Output precision
   int output_precision;
 
+  // Scaling study flag
+  bool scaling_study_flag;
+
+  // Thread counts and agent multipliers swept by the scaling study
+  std::vector<int> scaling_threads;
+  std::vector<T> scaling_multipliers;
+
+  // Number of iterations per scaling study configuration
+  int scaling_iterations;
+
   // Friends
   friend class GlobalParametersImGuiHandle<T>;
 
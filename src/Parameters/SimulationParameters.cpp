@@ -10,13 +10,15 @@ SimulationParameters<T>::SimulationParameters()
     simulation_parameters_initialized(false),
     simulation_config_file(""),
     worldsize{1.0, 1.0, 1.0},
+    periodic(false),
     dt(1.0),
     simulated_time(1),
     seed(0),
     space_scaling_factor(1.0),
     inv_space_scaling_factor(1.0),
     num_runs(1),
-    memory_size(1)
+    memory_size(1),
+    neighbor_skin(0.0)
 {
 #ifdef DEBUG
   std::cout << "SimulationParameters: Default constructor" << std::endl;
@@ -67,6 +69,9 @@ SimulationParameters<T>
   for (int i = 0; i < 3; i++){
     worldsize[i] = p.worldsize[i];
   }
+
+  // Set periodic boundaries
+  periodic = p.periodic;
   
   // Set time step
   dt = p.dt;
@@ -83,6 +88,12 @@ SimulationParameters<T>
   // Set memory size
   memory_size = p.memory_size;
 
+  // Set the skin of the neighbor lists
+  neighbor_skin = p.neighbor_skin;
+
+  // Copy the class ids of the relations
+  relation_ids = p.relation_ids;
+
   // Set scaling factors
   space_scaling_factor = p.space_scaling_factor;
   inv_space_scaling_factor = p.inv_space_scaling_factor;
@@ -121,6 +132,9 @@ for (int i = 0; i < 3; i++){
     scaled_params.worldsize[i] *= scaled_params.space_scaling_factor;
   }
 
+  // Scale the skin of the neighbor lists
+  scaled_params.neighbor_skin *= scaled_params.space_scaling_factor;
+
   // Scale agent classes
   for (int i = 0; i < num_agent_classes; i++){
     scaled_params.agent_class_params[i] = 
@@ -226,11 +240,22 @@ void SimulationParameters<T>::parseSimulationConfig(std::string filename)
       handleError("Key 'worldsize' not found in section 'world'\n\
           using default values: 1.0, 1.0, 1.0", WARNING);
     }
+
+    // Set periodic boundaries
+    if (config["world"].as_table()->contains("periodic")){
+      periodic = config["world"]["periodic"].value_or(false);
+    } else {
+      // Periodic not found
+      periodic = false;
+      handleError("Key 'periodic' not found in section 'world',\
+          \n using false, agents are reflected at the boundaries", WARNING);
+    }
   } else {
     // World section not found
     for (int i = 0; i < 3; i++) {
       this->worldsize[i] = 1.0;
     }
+    periodic = false;
     handleError("Section 'world' not found in configuration file\n\
         using default values: 1.0, 1.0, 1.0", WARNING);
   }
@@ -291,6 +316,10 @@ void SimulationParameters<T>::parseSimulationConfig(std::string filename)
           WARNING);
     }
 
+    // Set the skin of the neighbor lists, optional, without a skin all
+    // agent pairs are calculated in every step
+    neighbor_skin = config["simulation"]["neighbor_skin"].value_or(0.0);
+
   } else {
     // Simulation section not found
       
@@ -300,6 +329,7 @@ void SimulationParameters<T>::parseSimulationConfig(std::string filename)
     seed = 0;
     num_runs = 1;
     memory_size = 1;
+    neighbor_skin = 0.0;
 
     handleError("Section 'simulation' not found in configuration file.\n\
        Using default values: dt=1.0, simulated_time=86400, seed=0, num_runs=1",
@@ -477,6 +507,14 @@ void SimulationParameters<T>::parseAgentClassSection(toml::table &config)
                 color,
                 classdef["pointsize"].value_or(1.0f));
 
+            // Optional population dynamics, the defaults keep the number
+            // of agents fixed
+            AgentClassParameters<T> &c = agent_class_params.back();
+            c.setMaxAgents(classdef["max_agents"].value_or(0));
+            c.setReproductionEnergy(
+                classdef["reproduction_energy"].value_or(0.0f));
+            c.setRespawn(classdef["respawn"].value_or(true));
+
           } else {
             // AgentClassParameters definition incomplete
             // Set default values
@@ -552,6 +590,38 @@ const T* SimulationParameters<T>::getWorldsize() const
   return worldsize;
 }
 
+template <typename T>
+void SimulationParameters<T>::setPeriodic(bool flag)
+{
+#ifdef DEBUG
+  std::cout << "SimulationParameters::setPeriodic \
+    Setting periodic boundaries" << std::endl;
+#endif
+
+  // Set periodic boundaries
+  periodic = flag;
+}
+
+template <typename T>
+bool SimulationParameters<T>::getPeriodic() const
+{
+#ifdef DEBUG
+  /*
+  std::cout << "SimulationParameters::getPeriodic \
+    Getting periodic boundaries" << std::endl;
+    */
+#endif
+
+  // Get periodic boundaries
+  return periodic;
+}
+
+template <typename T>
+const T* SimulationParameters<T>::getPeriodicBox() const
+{
+  return periodic ? worldsize : NULL;
+}
+
 template <typename T>
 void SimulationParameters<T>::initDistributions()
 {
@@ -571,11 +641,12 @@ void SimulationParameters<T>::initDistributions()
 template <typename T>
 void SimulationParameters<T>::countAgents()
 {
-  // Count number of agents
+  // Count number of agents, every class holds the slots of its largest 
+  // number of agents
   num_agents_total = 0;
   for (int i=0; i<num_agent_classes; i++){
     agent_class_params[i].start_index = num_agents_total;
-    num_agents_total += agent_class_params[i].num_agents;
+    num_agents_total += agent_class_params[i].getCapacity();
     agent_class_params[i].stop_index = num_agents_total; 
   }
 
@@ -931,6 +1002,32 @@ int SimulationParameters<T>::getMemorySize()
   return memory_size;
 }
 
+template <typename T>
+void SimulationParameters<T>::setNeighborSkin(T skin)
+{
+#ifdef DEBUG
+  std::cout << "SimulationParameters::setNeighborSkin \
+    Setting the skin of the neighbor lists" << std::endl;
+#endif
+
+  // Set the skin of the neighbor lists
+  neighbor_skin = skin;
+}
+
+template <typename T>
+T SimulationParameters<T>::getNeighborSkin() const
+{
+#ifdef DEBUG
+  /*
+  std::cout << "SimulationParameters::getNeighborSkin \
+    Getting the skin of the neighbor lists" << std::endl;
+    */
+#endif
+
+  // Get the skin of the neighbor lists
+  return neighbor_skin;
+}
+
 template <typename T>
 void SimulationParameters<T>::setFoodSources(
     std::vector<std::string> &food_sources, int class_id)
@@ -1139,6 +1236,30 @@ std::vector<int> SimulationParameters<T>::getEnemyIds(int class_id) const
   return enemy_ids;
 }
 
+template <typename T>
+void SimulationParameters<T>::initRelations()
+{
+#ifdef DEBUG
+  std::cout << "SimulationParameters::initRelations \
+    Collecting the class ids of the relations" << std::endl;
+#endif
+
+  relation_ids.assign(num_agent_classes * NUM_RELATIONS, 
+      std::vector<int>());
+  for (int c = 0; c < num_agent_classes; c++){
+    relation_ids[c * NUM_RELATIONS + RELATION_FOOD] = getFoodSourceIds(c);
+    relation_ids[c * NUM_RELATIONS + RELATION_FRIEND] = getFriendIds(c);
+    relation_ids[c * NUM_RELATIONS + RELATION_ENEMY] = getEnemyIds(c);
+  }
+}
+
+template <typename T>
+const std::vector<int> &SimulationParameters<T>::getRelationIds(
+    int class_id, int relation) const
+{
+  return relation_ids[class_id * NUM_RELATIONS + relation];
+}
+
 template <typename T>
 T SimulationParameters<T>::getSpaceScalingFactor() const
 {
@@ -1245,6 +1366,7 @@ void SimulationParameters<T>::printSimulationParameters(
   stream << "  seed = " << seed << std::endl;
   stream << "  num_runs = " << num_runs << std::endl;
   stream << "  memory_size = " << memory_size << std::endl;
+  stream << "  neighbor_skin = " << neighbor_skin << std::endl;
 #ifdef DEBUG
   stream << "  num_agents_total = " << num_agents_total << std::endl;
 #endif
@@ -1254,6 +1376,7 @@ void SimulationParameters<T>::printSimulationParameters(
   stream << "[world]" << std::endl;
   stream << "  worldsize = [" << worldsize[0] << ", " 
     << worldsize[1] << ", " << worldsize[2] << "]" << std::endl;
+  stream << "  periodic = " << (periodic ? "true" : "false") << std::endl;
   stream << std::endl;
 
   // Agent classes section
@@ -1334,6 +1457,13 @@ bool SimulationParameters<T>::isInsideWorld(const Point3D<T> &p) const
 
   return true;
 }
+
+template <typename T>
+void SimulationParameters<T>::wrapIntoWorld(Point3D<T> &p) const
+{
+  // The world spans -worldsize to worldsize
+  p.wrapInto(worldsize);
+}
   
 // Explicit instantiation
 template class SimulationParameters<float>;
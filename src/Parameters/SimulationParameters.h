@@ -19,6 +19,12 @@
 // https://github.com/marzer/tomlplusplus.git
 #include "toml.hpp"
 
+// Relations of an agent class to other agent classes
+#define RELATION_FOOD 0
+#define RELATION_FRIEND 1
+#define RELATION_ENEMY 2
+#define NUM_RELATIONS 3
+
 template <typename T>
 class SimulationParametersImGuiHandle;
 
@@ -59,6 +65,14 @@ class SimulationParameters
   void getWorldsize(T* dims) const;
   const T* getWorldsize() const;
 
+  // Set/get periodic boundaries of the world
+  void setPeriodic(bool flag);
+  bool getPeriodic() const;
+
+  // Half sizes of a periodic world, the distances take the closest
+  // image, NULL if the world reflects at its boundaries
+  const T* getPeriodicBox() const;
+
   // Set/get initialized flag for simulation parameters
   void setSimParamsInitialized(bool flag);
   bool getSimParamsInitialized();
@@ -115,6 +129,10 @@ class SimulationParameters
   void setMemorySize(int n);
   int getMemorySize();
 
+  // Set/get the skin of the neighbor lists
+  void setNeighborSkin(T skin);
+  T getNeighborSkin() const;
+
   // Get/set food sources
   void setFoodSources(std::vector<std::string> &food_sources, int class_id);
   std::vector<std::string> getFoodSources(int class_id) const;
@@ -130,6 +148,13 @@ class SimulationParameters
   std::vector<std::string> getEnemies(int class_id) const;
   std::vector<int> getEnemyIds(int class_id) const;
 
+  // Collect the class ids of the food sources, friends and enemies of 
+  // every class, call after the classes are set
+  void initRelations();
+
+  // Class ids of a relation of a class, see initRelations
+  const std::vector<int> &getRelationIds(int class_id, int relation) const;
+
   // Get space scaling factor
   T getSpaceScalingFactor() const;
   T getInverseSpaceScalingFactor() const;
@@ -149,6 +174,9 @@ class SimulationParameters
   // Test if a point is inside the world
   bool isInsideWorld(const Point3D<T> &p) const;
 
+  // Map a point of a periodic world into the world
+  void wrapIntoWorld(Point3D<T> &p) const;
+
 
   /* Public member variables */
 
@@ -171,6 +199,10 @@ class SimulationParameters
   // World size 
   T worldsize[3];
 
+  // Periodic boundaries, agents leaving the world on one side enter it
+  // on the other, otherwise they are reflected
+  bool periodic;
+
   // Time step in time/iteration
   T dt;
 
@@ -192,6 +224,14 @@ class SimulationParameters
   // Memory size, number of states to store
   int memory_size;
 
+  // Skin of the neighbor lists of the agent to agent masks,
+  // 0 computes all pairs in every step
+  T neighbor_skin;
+
+  // Class ids of the relations of every class, indexed by 
+  // class_id*NUM_RELATIONS + relation
+  std::vector<std::vector<int>> relation_ids;
+
 
 
  private:
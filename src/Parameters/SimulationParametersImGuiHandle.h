@@ -223,6 +223,12 @@ class SimulationParametersImGuiHandle
       sim_params_new.setWorldsize(dims);
     }
 
+    // Set periodic boundaries
+    bool periodic = sim_params_new.getPeriodic();
+    if (ImGui::Checkbox("Periodic boundaries", &periodic)){
+      sim_params_new.setPeriodic(periodic);
+    }
+
     // Set time step
     T dt = sim_params_new.getDt();
     if (ImGui::InputScalar("Time step", ImGuiDataType_Float, &dt)){
@@ -242,6 +248,13 @@ class SimulationParametersImGuiHandle
       sim_params_new.setNumRuns(num_runs);
     }
 
+    // Set the skin of the neighbor lists
+    ImGui::SeparatorText("Neighbor list skin, 0 to calculate all pairs");
+    T skin = sim_params_new.getNeighborSkin();
+    if (ImGui::InputScalar("Neighbor skin", ImGuiDataType_Float, &skin)){
+      sim_params_new.setNeighborSkin(skin);
+    }
+
     ImGui::SeparatorText("Seed = 0 for non-deterministic behavior");
 
     // Set random number generator seed
@@ -317,6 +317,195 @@ void Simulation<T>::runHeadless()
   return run(num_iterations, num_repeats);
 }
 
+template <typename T>
+void Simulation<T>::runScalingStudy()
+{
+#ifdef DEBUG
+  std::cout << "Simulation::runScalingStudy: \
+    Running the scaling study" << std::endl;
+#endif
+
+  // Thread counts and agent multipliers to sweep
+  std::vector<int> threads = global_params.getScalingThreads();
+  const std::vector<T> &multipliers = global_params.getScalingMultipliers();
+  int num_iterations = global_params.getScalingIterations();
+
+#ifdef PARALLEL
+  int max_threads = omp_get_max_threads();
+#else
+  // The serial version can only sweep the agent multipliers
+  handleError("Simulation::runScalingStudy: Serial version, \
+      only agent multipliers are swept", WARNING);
+  threads = {1};
+#endif
+
+  if (threads.empty() || multipliers.empty()){
+    handleError("Simulation::runScalingStudy: Nothing to sweep", WARNING);
+    return;
+  }
+
+  // The configured parameters are the base of every configuration
+  SimulationParameters<T> base_params = sim_params;
+  SimulationParameters<T> params = sim_params;
+  int num_classes = base_params.getNumAgentClasses();
+
+  std::vector<ScalingStudyResult> results;
+  status = SimulationState::RUNNING;
+
+  for (int m = 0; m < (int)multipliers.size(); m++){
+
+    // Scale the number of agents of every class
+    for (int c = 0; c < num_classes; c++){
+      int n = base_params.getAgentClass(c).num_agents;
+      params.getAgentClass(c).num_agents = (n > 0) ? 
+        std::max(1, static_cast<int>(std::lround(multipliers[m] * n))) : 0;
+      int n_max = base_params.getAgentClass(c).max_agents;
+      params.getAgentClass(c).max_agents = (n_max > 0) ? 
+        std::max(1, static_cast<int>(std::lround(multipliers[m] * n_max))) : 0;
+    }
+    params.countAgents();
+
+    // First result of this multiplier is the strong scaling reference
+    int strong_ref_index = (int)results.size();
+
+    for (int t = 0; t < (int)threads.size(); t++){
+#ifdef PARALLEL
+      omp_set_num_threads(threads[t]);
+#endif
+
+      // Start from the initial state of the configuration
+      state_machine.init(params);
+      if (!state_machine.getInitialized()){
+        handleError("Simulation::runScalingStudy: \
+            State machine could not be initialized", WARNING);
+        continue;
+      }
+
+      // Time the iterations
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < num_iterations; i++){
+        state_machine.updateState();
+      }
+      auto stop = std::chrono::high_resolution_clock::now();
+      double seconds = std::chrono::duration<double>(stop - start).count();
+
+      ScalingStudyResult r;
+      r.multiplier = multipliers[m];
+      r.num_agents = params.getNumAgents();
+      r.num_threads = threads[t];
+      r.seconds = seconds;
+      r.steps_per_second = num_iterations / seconds;
+
+      // Strong scaling, same problem size on more threads
+      const ScalingStudyResult &strong_ref = 
+        ((int)results.size() == strong_ref_index) ? r : results[strong_ref_index];
+      r.strong_efficiency = 
+        (r.steps_per_second / strong_ref.steps_per_second) 
+        / (static_cast<double>(r.num_threads) / strong_ref.num_threads);
+
+      // Weak scaling, problem size grows with the number of threads. A
+      // step costs O(N^2) agent pairs, the steps per second are weighted
+      // by the ratio of the pairs
+      r.weak_efficiency = -1.0;
+      const ScalingStudyResult &weak_ref = results.empty() ? r : results[0];
+      double agent_ratio = 
+        static_cast<double>(r.num_agents) / weak_ref.num_agents;
+      double thread_ratio = 
+        static_cast<double>(r.num_threads) / weak_ref.num_threads;
+      if (std::abs(agent_ratio - thread_ratio) < 1e-2 * thread_ratio){
+        double pair_ratio = agent_ratio * agent_ratio;
+        r.weak_efficiency = 
+          (r.steps_per_second / weak_ref.steps_per_second) 
+          * pair_ratio / thread_ratio;
+      }
+
+      results.push_back(r);
+
+      std::cout << "Simulation::runScalingStudy: agents: " << r.num_agents 
+        << " threads: " << r.num_threads 
+        << " steps/s: " << r.steps_per_second 
+        << " efficiency: " << r.strong_efficiency << std::endl;
+    }
+  }
+
+#ifdef PARALLEL
+  // Restore the thread count
+  omp_set_num_threads(max_threads);
+#endif
+
+  status = SimulationState::STOPPED;
+
+  // Write the report
+  saveScalingStudy(results);
+}
+
+template <typename T>
+void Simulation<T>::saveScalingStudy(
+    const std::vector<ScalingStudyResult> &results)
+{
+#ifdef DEBUG
+  std::cout << "Simulation::saveScalingStudy: \
+    Saving the scaling study report" << std::endl;
+#endif
+
+  std::string basename = global_params.getRuntimeDirectory() 
+    + "/scaling_study";
+
+  // CSV report
+  std::ofstream csv(basename + ".csv");
+  if (!csv.is_open()){
+    handleError("Simulation::saveScalingStudy: Could not open " 
+        + basename + ".csv", WARNING);
+    return;
+  }
+  csv << "multiplier,num_agents,num_threads,seconds,steps_per_second,"
+    << "strong_efficiency,weak_efficiency" << std::endl;
+  for (const ScalingStudyResult &r : results){
+    csv << r.multiplier << "," << r.num_agents << "," << r.num_threads << ","
+      << r.seconds << "," << r.steps_per_second << "," 
+      << r.strong_efficiency << ",";
+    if (r.weak_efficiency >= 0.0){
+      csv << r.weak_efficiency;
+    }
+    csv << std::endl;
+  }
+  csv.close();
+
+  // JSON report
+  std::ofstream json(basename + ".json");
+  if (!json.is_open()){
+    handleError("Simulation::saveScalingStudy: Could not open " 
+        + basename + ".json", WARNING);
+    return;
+  }
+  json << "{" << std::endl;
+  json << "  \"iterations\": " << global_params.getScalingIterations() 
+    << "," << std::endl;
+  json << "  \"results\": [" << std::endl;
+  for (int i = 0; i < (int)results.size(); i++){
+    const ScalingStudyResult &r = results[i];
+    json << "    {\"multiplier\": " << r.multiplier
+      << ", \"num_agents\": " << r.num_agents
+      << ", \"num_threads\": " << r.num_threads
+      << ", \"seconds\": " << r.seconds
+      << ", \"steps_per_second\": " << r.steps_per_second
+      << ", \"strong_efficiency\": " << r.strong_efficiency
+      << ", \"weak_efficiency\": ";
+    if (r.weak_efficiency >= 0.0){
+      json << r.weak_efficiency;
+    } else {
+      json << "null";
+    }
+    json << "}" << ((i < (int)results.size() - 1) ? "," : "") << std::endl;
+  }
+  json << "  ]" << std::endl;
+  json << "}" << std::endl;
+  json.close();
+
+  std::cout << "Simulation::saveScalingStudy: Report written to " 
+    << basename << ".{csv,json}" << std::endl;
+}
+
 template <typename T>
 void Simulation<T>::stop()
 {
@@ -567,6 +756,19 @@ T* Simulation<T>::getAgentClassPointer(int class_id)
   return state_machine.getAgentClassPointer(class_id);
 }
 
+template <typename T>
+T* Simulation<T>::getAgentClassPositions(int class_id, int &num_points)
+{
+#ifdef DEBUG
+  /*
+  std::cout << "Simulation::getAgentClassPositions: \
+    Getting the positions of the agent class" << std::endl;
+    */
+#endif
+
+  return state_machine.getAgentClassPositions(class_id, num_points);
+}
+
 template <typename T>
 void Simulation<T>::getDims(T *dims)
 {
@@ -8,6 +8,8 @@
 #include <time.h>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <fstream>
 #include <chrono>
 #include <thread>
 #include <cmath>
@@ -22,6 +24,18 @@ enum class SimulationState
   RUNNING
 };
 
+// Result of one configuration of the scaling study
+struct ScalingStudyResult
+{
+  double multiplier;
+  int num_agents;
+  int num_threads;
+  double seconds;
+  double steps_per_second;
+  double strong_efficiency;
+  double weak_efficiency; // negative if not a weak scaling configuration
+};
+
 // Forward declaration of SimulationImGuiHandle
 template <typename T>
 class SimulationImGuiHandle;
@@ -53,6 +67,9 @@ class Simulation
   void run(int num_iterations, int num_repeats);
   void runHeadless();
 
+  // Sweep thread counts and agent multipliers, measure the throughput
+  void runScalingStudy();
+
   // Pause the simulation
   void pause();
 
@@ -94,6 +111,9 @@ class Simulation
   // Get pointer to data
   T* getAgentClassPointer(int class_id);
 
+  // Get the positions of the agents of a class without the free slots
+  T* getAgentClassPositions(int class_id, int &num_points);
+
   // Get the dimensions of the simulation 
   void getDims(T *dims);
 
@@ -147,6 +167,9 @@ class Simulation
   // Reset counters
   void resetCounters();
 
+  // Write the scaling study report as csv and json
+  void saveScalingStudy(const std::vector<ScalingStudyResult> &results);
+
   // Run flag for the gui
   bool gui_flag;
  
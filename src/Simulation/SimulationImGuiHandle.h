@@ -442,7 +442,10 @@ class SimulationImGuiHandle
       simulation.reset();
       for (int i=0; i<point_clouds.size(); i++){
         // Update the buffer
-        point_clouds[i].setPoints(simulation.getAgentClassPointer(i));
+        int num_points;
+        T* pointer = simulation.getAgentClassPositions(i, num_points);
+        point_clouds[i].setPoints(pointer);
+        point_clouds[i].setNumPoints(num_points);
         point_clouds[i].initPointCloud();
       }
     }
@@ -527,11 +530,11 @@ class SimulationImGuiHandle
     // For every agent class create a point cloud
     for (int i=0; i<sim_params.getNumAgentClasses(); i++){
       int pointsize = sim_params.getAgentClass(i).getPointsize();
-      int num_points = sim_params.getAgentClass(i).getNumAgents();
       std::string name = sim_params.getAgentClass(i).getName();
       Color<T> color = sim_params.getAgentClass(i).getColor();
-      // Pointer to the data
-      T* pointer = simulation.getAgentClassPointer(i);
+      // Pointer to the data, the free slots of the class are left out
+      int num_points;
+      T* pointer = simulation.getAgentClassPositions(i, num_points);
       point_clouds.emplace_back(
           shader, window, pointer, num_points, pointsize, name, color);
     }
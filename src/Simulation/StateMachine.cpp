@@ -6,9 +6,14 @@
 template <typename T>
 StateMachine<T>::StateMachine(std::random_device &rd, 
     GlobalParameters<T> &p_global)
-  :rd(rd), new_state(), p_global(p_global),
-  restore_file(".state_backup.toml"), initialized(false), 
-  log_flags{0}, gen(rd())
+  :p_global(p_global), new_state(), rd(rd), gen(rd()), brownian_key(0),
+  search_state(gen, dist_uni, dist_x, dist_y, dist_z),
+  agent_data(sp_scaled, agents, agent_classes, system_metrics.agent_metrics,
+      gen, dist_uni, dist_x, dist_y, dist_z, search_state),
+  log_flags{0}, meta_previous(NULL), meta_reusable(false), 
+  use_neighbor_lists(false), neighbors_dense(false), neighbor_recheck(0), 
+  meta_neighbors(false), initialized(false), 
+  restore_file(".state_backup.toml")
 {
 #ifdef DEBUG
   std::cout << "StateMachine::StateMachine: \
@@ -17,6 +22,7 @@ StateMachine<T>::StateMachine(std::random_device &rd,
 
   for (int i = 0; i < (int)LogFlags::NUM_LOG_FLAGS; i++){
     log_flags[i] = false;
+    meta_plan[i] = true;
   }
 
 }
@@ -96,6 +102,9 @@ void StateMachine<T>::init(SimulationParameters<T> &p)
   // Initialize the agent metrics
   initAgentMetrics();
 
+  //Initialize the log flags and the plan of derived quantities
+  initLogFlags();
+
   // Update the meta data of the simulation
   updateMeta(new_state);
 
@@ -135,12 +144,11 @@ void StateMachine<T>::init(SimulationParameters<T> &p)
   // Initialize the output directory
   p_global.initRunDirectory();
 
-  // Save the initial state
-  std::string filename = p_global.getRunDirectory() + "/initial_state.toml";
-  saveStateToml(states[0], filename);
-  
-  //Initialize the log flags
-  initLogFlags();
+  // Save the initial state, the runs of the scaling study are not kept
+  if (!p_global.getScalingStudyFlag()){
+    std::string filename = p_global.getRunDirectory() + "/initial_state.toml";
+    saveStateToml(states[0], filename);
+  }
 
   // Print the agent class summary
   if (p_global.getVerbosity() > 0){
@@ -254,8 +262,9 @@ void StateMachine<T>::updateState()
   // Transition of the state of the simulation
   transition(states[1], states[0], new_state);
 
-  // Update the meta data of the simulation
-  updateMeta(new_state);
+  // Update the meta data of the simulation, the rows of the agents 
+  // which did not change are taken from the current state
+  updateMeta(new_state, meta_reusable ? &states[0] : NULL);
 
   // Set the initialized flag
   new_state.setInitialized(true);
@@ -317,59 +326,318 @@ void StateMachine<T>::transition(const State<T> &old_state,
   // distance moved
   updateEnergy(state, new_state);
 
-  // Update the status of the agents, always call last,
-  // can override all other updates (case respawn)
+  // Update the status of the agents, can override all other updates 
+  // (case respawn)
   updateStatus(state, new_state);
+
+  // Births and freed slots, always call last, moves agents between 
+  // slots
+  updatePopulation(state, new_state);
+}
+
+template <typename T>
+void StateMachine<T>::updatePopulation(const State<T> &state, 
+    State<T> &new_state)
+{
+  // Fixed populations keep their slots
+  if (!population.isDynamic()){
+    return;
+  }
+
+#ifdef DEBUG
+  std::cout << "StateMachine::updatePopulation: \
+    Updating the population of the agents" << std::endl;
+#endif
+
+  // Free the slots of the agents which died without respawn
+  population.update(state, new_state);
+
+  // Births in the order of the agents, agents born or respawned in this
+  // step do not reproduce, a child can take a slot freed in this step
+  // above its parent, a full class has no births
+  for (int c = 0; c < sp_scaled.num_agent_classes; c++){
+    const AgentClassParameters<T> &p = sp_scaled.getAgentClass(c);
+    if (p.reproduction_energy <= 0.0){
+      continue;
+    }
+    for (int i = p.start_index; i < p.stop_index; i++){
+      if (agent_data.born[i] || !isActive(state.status[i]) 
+          || !isActive(new_state.status[i])
+          || new_state.energy[i] < p.reproduction_energy){
+        continue;
+      }
+      const int child_id = population.acquire(c);
+      if (child_id < 0){
+        break;
+      }
+      agents[i].reproduce(new_state, child_id);
+    }
+  }
+  std::fill(agent_data.born.begin(), agent_data.born.end(), 0);
+
+  // Move the agents into the free slots at the front of their class,
+  // they continue their search there
+  if (state.iteration % POPULATION_COMPACT_INTERVAL != 0){
+    return;
+  }
+  population.compact(new_state, population_moves);
+  for (const std::pair<int, int> &move : population_moves){
+    search_state.copyAgent(move.first, move.second);
+    agent_data.transition_state[move.second] = 
+      agent_data.transition_state[move.first];
+    agent_data.transition_state[move.first] = Status::VACANT;
+  }
 }
 
 template <typename T>
-void StateMachine<T>::updateMeta(State<T> &state)
+void StateMachine<T>::updateMeta(State<T> &state, 
+    const State<T> *previous)
 {
 #ifdef DEBUG
   std::cout << "StateMachine::updateMeta: \
     Updating the meta data of the simulation" << std::endl;
 #endif
 
+  // The rows of the previous state can only be reused with the same 
+  // layout
+  if (previous != NULL && (!previous->getInitialized() 
+        || previous->num_agents_total != state.num_agents_total
+        || previous->num_classes != state.num_classes)){
+    previous = NULL;
+  }
+
+  // Rebuild the neighbor lists if agents moved by more than the skin,
+  // lists which turned out too dense are rebuilt every 
+  // NEIGHBOR_RECHECK_INTERVAL steps to check the density again
+  bool neighbors = false;
+  if (use_neighbor_lists && neighbor_recheck > 0){
+    neighbor_recheck--;
+  } else if (use_neighbor_lists){
+    if (neighbors_dense){
+      neighbor_lists.invalidate();
+    }
+    if (neighbor_lists.update(state)){
+#ifdef DEBUG
+      if (p_global.getVerbosity() > 2){
+        std::cout << "StateMachine::updateMeta: \
+          Neighbor list build " << neighbor_lists.getNumBuilds() 
+          << ", candidates: " << neighbor_lists.getNumCandidates() 
+          << std::endl;
+      }
+#endif
+    }
+    const long num_pairs = 
+      (long)state.num_agents_total * state.num_agents_total;
+    const bool dense = 
+      (long)neighbor_lists.getNumCandidates() * NEIGHBOR_MAX_FILL >= num_pairs;
+
+    // Dense lists do not pay, the radii are too large for the extent of 
+    // the agents, all pairs are calculated until the next check
+    if (dense != neighbors_dense && p_global.getVerbosity() > 1){
+      std::cout << "StateMachine::updateMeta: \
+        Neighbor lists with " << neighbor_lists.getNumCandidates() 
+        << " candidates are " << (dense ? "too dense, calculating all pairs" 
+            : "sparse again, using the lists") << std::endl;
+    }
+    neighbors_dense = dense;
+    neighbor_recheck = dense ? NEIGHBOR_RECHECK_INTERVAL - 1 : 0;
+    neighbors = !dense;
+  }
+
+  // Rows calculated from the neighbor lists lack the other pairs
+  if (meta_neighbors){
+    previous = NULL;
+  }
+
+  // Alive, moving and changed agents, read by the agent to agent kernels
+  compactAgents(state, previous);
+  meta_previous = previous;
+
 #pragma omp parallel
   {
-    // Calculate the distances between agents
-    calculateDistancesAgentToAgent(state);
+    if (neighbors){
+      // Only the pairs which can perceive each other
+      calculateNeighborsAgentToAgent(state);
+    } else {
+#ifdef COMPACT_DISTANCES
+      // The stored distances are rounded, calculate the masks on the 
+      // full precision distances in the same pass
+      if (meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_AGENT]){
+        calculateCompactDistancesAgentToAgent(state);
+      }
+#else
+      // Calculate the distances between agents
+      if (meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_AGENT]){
+        calculateDistancesAgentToAgent(state);
+      }
 
-    // Calculate the audibility of agents
-    calculateAudibilityAgentToAgent(state);
+      // Calculate the audibility of agents
+      if (meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT]){
+        calculateAudibilityAgentToAgent(state);
+      }
 
-    // Calculate the reachability of agents
-    calculateReachabilityAgentToAgent(state);
+      // Calculate the reachability of agents
+      if (meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT]){
+        calculateReachabilityAgentToAgent(state);
+      }
 
-    // Calculate the contact of agents
-    calculateContactAgentToAgent(state);
+      // Calculate the contact of agents
+      if (meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT]){
+        calculateContactAgentToAgent(state);
+      }
+#endif
+    }
+
+    // Build the spatial indices of the classes, the closest agent
+    // queries of the agents search them instead of the class range
+#pragma omp for schedule(dynamic)
+    for (int c = 0; c < (int)agent_classes.size(); c++){
+      agent_classes[c].buildTree(state);
+    }
 
 
     // Calculate the avg distances between agents and classes
-    calculateDistancesAgentToClass(state);
+    if (meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_CLASS]){
+      calculateDistancesAgentToClass(state);
+    }
 
     // Calculate the audibility of agents to classes
-    calculateAudibilityAgentToClass(state);
+    if (meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_CLASS]){
+      calculateAudibilityAgentToClass(state);
+    }
 
     // Calculate the reachability of agents to classes
-    calculateReachabilityAgentToClass(state);
+    if (meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_CLASS]){
+      calculateReachabilityAgentToClass(state);
+    }
 
     // Calculate the contact of agents to classes
-    calculateContactAgentToClass(state);
+    if (meta_plan[(int)LogFlags::CONTACT_AGENT_TO_CLASS]){
+      calculateContactAgentToClass(state);
+    }
 
 
     // Calculate the avg distances between classes
-    calculateDistancesClassToClass(state);
+    if (meta_plan[(int)LogFlags::DISTANCES_CLASS_TO_CLASS]){
+      calculateDistancesClassToClass(state);
+    }
 
     // Calculate the audibility of classes
-    calculateAudibilityClassToClass(state);
+    if (meta_plan[(int)LogFlags::AUDIBILITY_CLASS_TO_CLASS]){
+      calculateAudibilityClassToClass(state);
+    }
 
     // Calculate the reachability of classes
-    calculateReachabilityClassToClass(state);
+    if (meta_plan[(int)LogFlags::REACHABILITY_CLASS_TO_CLASS]){
+      calculateReachabilityClassToClass(state);
+    }
 
     // Calculate the contact of classes
-    calculateContactClassToClass(state);
+    if (meta_plan[(int)LogFlags::CONTACT_CLASS_TO_CLASS]){
+      calculateContactClassToClass(state);
+    }
+  }
+
+  // The awareness records of the agents are filled again on first use
+  agent_data.invalidateAwareness();
+
+  // The next state can take the rows of this one
+  meta_previous = NULL;
+  meta_reusable = true;
+  meta_neighbors = neighbors;
+}
+
+template <typename T>
+void StateMachine<T>::compactAgents(const State<T> &state, 
+    const State<T> *previous)
+{
+#ifdef DEBUG
+  if (p_global.getVerbosity() > 2){
+    std::cout << "StateMachine::compactAgents: \
+      Sorting the agents into alive, moving and changed" << std::endl;
+  }
+#endif
+
+  const int num_agents = state.num_agents_total;
+  alive_ids.clear();
+  moving_ids.clear();
+  changed_ids.clear();
+  window_moving_ids.clear();
+  window_changed_ids.clear();
+  moved_flags.assign(num_agents, 1);
+  changed_flags.assign(num_agents, 1);
+  alive_bits.assign(state.getMaskPitch(), 0);
+
+  // After a full update nothing is known about the older steps
+  if (previous == NULL || (int)moved_steps.size() != num_agents){
+    moved_steps.assign(num_agents, 0xff);
+    changed_steps.assign(num_agents, 0xff);
+  }
+  const uint8_t window = (1 << META_WINDOW) - 1;
+
+  for (int i = 0; i < num_agents; i++){
+    const bool alive = isActive(state.status[i]);
+    if (alive){
+      alive_ids.push_back(i);
+      setBit(alive_bits.data(), i);
+    }
+
+    // Without a previous state all agents are moving and changed
+    if (previous != NULL){
+      const Point3D<T> &p = previous->positions[i];
+      const Point3D<T> &q = state.positions[i];
+      moved_flags[i] = p.x != q.x || p.y != q.y || p.z != q.z;
+
+      // Inputs of the predicates of the masks
+      changed_flags[i] = moved_flags[i]
+        || previous->sizes[i] != state.sizes[i]
+        || previous->movespeed[i] != state.movespeed[i]
+        || previous->audibility_threshold[i] 
+          != state.audibility_threshold[i]
+        || isActive(previous->status[i]) != alive;
+    }
+    if (moved_flags[i]){
+      moving_ids.push_back(i);
+    }
+    if (changed_flags[i]){
+      changed_ids.push_back(i);
+    }
+
+    // Shift the flags of this step into the dirty tracking
+    if (previous != NULL){
+      moved_steps[i] = (moved_steps[i] << 1) | moved_flags[i];
+      changed_steps[i] = (changed_steps[i] << 1) | changed_flags[i];
+    }
+    if (moved_steps[i] & window){
+      window_moving_ids.push_back(i);
+    }
+    if (changed_steps[i] & window){
+      window_changed_ids.push_back(i);
+    }
   }
+
+  // The members of a class are contiguous and alive_ids is sorted
+  const int num_classes = sp_scaled.num_agent_classes;
+  class_alive_begin.resize(num_classes);
+  class_alive_end.resize(num_classes);
+  for (int j = 0; j < num_classes; j++){
+    const AgentClassParameters<T> &c = sp_scaled.agent_class_params[j];
+    class_alive_begin[j] = (int)(std::lower_bound(alive_ids.begin(), 
+        alive_ids.end(), c.start_index) - alive_ids.begin());
+    class_alive_end[j] = (int)(std::lower_bound(alive_ids.begin(), 
+        alive_ids.end(), c.stop_index) - alive_ids.begin());
+  }
+
+#ifdef DEBUG
+  if (p_global.getVerbosity() > 2){
+    std::cout << "StateMachine::compactAgents: \
+      Alive: " << alive_ids.size() << " moving: " << moving_ids.size()
+      << " changed: " << changed_ids.size() 
+      << " moving in the window: " << window_moving_ids.size()
+      << " changed in the window: " << window_changed_ids.size() 
+      << std::endl;
+  }
+#endif
 }
 
 template <typename T>
@@ -390,13 +658,16 @@ void StateMachine<T>::initAgents(const State<T> &state)
   // Initialize the agents
   agents.clear();
   agents.reserve(sp_scaled.num_agents_total);
+  search_state.init(sp_scaled.num_agents_total, sp_scaled);
+  agent_data.init(sp_scaled.num_agents_total, p_global.getVerbosity());
   for (int i = 0; i < sp_scaled.num_agents_total; i++){
-    agents.emplace_back(
-        i, p_global.getVerbosity(), sp_scaled, agents, agent_classes, 
-        system_metrics.agent_metrics, gen, dist_uni, dist_x, dist_y, dist_z);
+    agents.emplace_back(i, agent_data);
     agents[i].init(state);
   }
 
+  // Collect the free slots of the classes
+  population.init(sp_scaled, state);
+
   if (p_global.getVerbosity() > 3){
     std::cout << "StateMachine::initAgents: \
       Created " << agents.size() << " agents" << std::endl;
@@ -452,12 +723,14 @@ void StateMachine<T>::initStates()
   std::cout << "StateMachine::initStates: \
     Memory size: " << sp_scaled.memory_size << std::endl;
 #endif
-  // Allocate memory for the states
+  // Allocate memory for the full states, the transition reads the 
+  // current and the previous one, older states go to the history
   states.clear();
-  states.reserve(sp_scaled.memory_size);
-  for (int i = 0; i < sp_scaled.memory_size; i++){
+  states.reserve(NUM_FULL_STATES);
+  for (int i = 0; i < NUM_FULL_STATES; i++){
     states.emplace_back();
   }
+  history.init(sp_scaled.memory_size - NUM_FULL_STATES);
 
   if (p_global.getVerbosity() > 1){
     std::cout << "StateMachine::initStates: \
@@ -516,8 +789,133 @@ void StateMachine<T>::initLogFlags()
     log_flags[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT] = true;
     log_flags[(int)LogFlags::CONTACT_AGENT_TO_AGENT] = true;
   }
+
+  // Update the plan of derived quantities
+  initMetaPlan();
 }
 
+template <typename T>
+void StateMachine<T>::initMetaPlan()
+{
+#ifdef DEBUG
+  std::cout << "StateMachine::initMetaPlan: \
+    Initializing the plan of derived quantities" << std::endl;
+#endif
+
+  // Derived quantities read by the agents depend on the strategies.
+  // Strategies 1-6 query audible, reachable and contact counts and the
+  // closest agents, strategies 0, 7 and 8 do not look at other agents.
+  bool agent_counts = false;
+  for (int i = 0; i < sp_scaled.num_agent_classes; i++){
+    const AgentClassParameters<T> &c = sp_scaled.agent_class_params[i];
+    if (c.num_agents == 0){
+      continue;
+    }
+    if (c.strategy >= 1 && c.strategy <= 6){
+      agent_counts = true;
+    }
+    // Agents with food sources attack food in every strategy,
+    // attacked agents check if the enemy is still audible
+    if (!sp_scaled.getRelationIds(i, RELATION_FOOD).empty()){
+      agent_counts = true;
+    }
+  }
+
+  // Start with the logged quantities
+  for (int i = 0; i < (int)LogFlags::NUM_LOG_FLAGS; i++){
+    meta_plan[i] = log_flags[i];
+  }
+
+  // Class to class quantities are derived from agent to class quantities
+  if (meta_plan[(int)LogFlags::DISTANCES_CLASS_TO_CLASS]){
+    meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_CLASS] = true;
+  }
+  if (meta_plan[(int)LogFlags::AUDIBILITY_CLASS_TO_CLASS]){
+    meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_CLASS] = true;
+  }
+  if (meta_plan[(int)LogFlags::REACHABILITY_CLASS_TO_CLASS]){
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_CLASS] = true;
+  }
+  if (meta_plan[(int)LogFlags::CONTACT_CLASS_TO_CLASS]){
+    meta_plan[(int)LogFlags::CONTACT_AGENT_TO_CLASS] = true;
+  }
+
+  // The agents count on the bit packed masks directly, the closest agent
+  // queries skip classes using the agent to class counts
+  if (agent_counts){
+    meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_CLASS] = true;
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_CLASS] = true;
+    meta_plan[(int)LogFlags::CONTACT_AGENT_TO_CLASS] = true;
+    meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT] = true;
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT] = true;
+    meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT] = true;
+  }
+
+  // Agent to class quantities are derived from agent to agent quantities,
+  // which are also read by the agents to find the closest agents
+  if (meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_CLASS]){
+    meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT] = true;
+  }
+  if (meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_CLASS]){
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT] = true;
+  }
+  if (meta_plan[(int)LogFlags::CONTACT_AGENT_TO_CLASS]){
+    meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT] = true;
+  }
+
+  // Everything is derived from the distances
+  if (meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_CLASS]
+      || meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT]
+      || meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT]
+      || meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT]){
+    meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_AGENT] = true;
+  }
+
+#ifdef DEBUG
+  // The debug output prints all derived quantities
+  for (int i = 0; i < (int)LogFlags::NUM_LOG_FLAGS; i++){
+    meta_plan[i] = true;
+  }
+#endif
+
+  if (p_global.getVerbosity() > 1){
+    int num_skipped = 0;
+    for (int i = (int)LogFlags::DISTANCES_AGENT_TO_AGENT; 
+        i < (int)LogFlags::NUM_LOG_FLAGS; i++){
+      num_skipped += !meta_plan[i];
+    }
+    std::cout << "StateMachine::initMetaPlan: \
+      Skipping " << num_skipped << " of 12 derived quantities" << std::endl;
+  }
+
+  // The neighbor lists skip the pairs which cannot perceive each 
+  // other, their distances are not calculated
+  const bool masks = meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT]
+    || meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT]
+    || meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT];
+  const bool all_distances = 
+    meta_plan[(int)LogFlags::DISTANCES_AGENT_TO_CLASS]
+    || log_flags[(int)LogFlags::DISTANCES_AGENT_TO_AGENT];
+  use_neighbor_lists = sp_scaled.neighbor_skin > 0 && masks 
+    && !all_distances;
+  neighbors_dense = false;
+  neighbor_recheck = 0;
+  neighbor_lists.init(sp_scaled.neighbor_skin, sp_scaled.getPeriodicBox());
+  if (sp_scaled.neighbor_skin > 0 && masks && all_distances){
+    handleError("StateMachine::initMetaPlan: The distances of all pairs \
+      are needed, not using the neighbor lists", WARNING);
+  }
+  if (p_global.getVerbosity() > 1 && use_neighbor_lists){
+    std::cout << "StateMachine::initMetaPlan: \
+      Using neighbor lists with skin " << sp_scaled.neighbor_skin 
+      << std::endl;
+  }
+
+  // The current state may lack quantities of the new plan
+  meta_reusable = false;
+}
+
+
 
 template <typename T>
 void StateMachine<T>::initParameters()
@@ -539,6 +937,9 @@ void StateMachine<T>::initParameters()
 
   // Set the distributions, call after scaling
   sp_scaled.initDistributions();
+
+  // Class ids of the food sources, friends and enemies of every class
+  sp_scaled.initRelations();
 }
 
 template <typename T>
@@ -555,11 +956,13 @@ void StateMachine<T>::initRandom()
       std::cout << "Using random seed" << std::endl;
     }
     gen.seed(rd());
+    brownian_key = ((uint64_t)rd() << 32) ^ (uint64_t)rd();
   }else{
     if (p_global.getVerbosity() > 0){
       std::cout << "Using fixed seed: " << sp_scaled.seed << std::endl;
     }
     gen.seed(sp_scaled.seed);
+    brownian_key = (uint64_t)sp_scaled.seed;
   }
 
   // Initialize the distributions of the agent classes
@@ -800,9 +1203,11 @@ void StateMachine<T>::initStatus(State<T> &state)
     // Get the class
     AgentClassParameters<T> &c = sp_scaled.getAgentClass(i);
 
-    // Initialize the status of the agents
+    // Initialize the status of the agents, the slots beyond the initial
+    // number of agents are free
     for (int j = c.start_index; j < c.stop_index; j++){
-        state.status[j] = c.status;
+        state.status[j] = (j < c.start_index + c.num_agents) ? c.status 
+          : (int)Status::VACANT;
     }
   }
 }
@@ -844,8 +1249,9 @@ void StateMachine<T>::initPositions(State<T> &state)
     // Initialize the positions of the agents
     for (int j=c.start_index; j<c.stop_index; j++){
 
-      // Set the position of the agent
-      if (c.random_start_positions) {
+      // Set the position of the agent, free slots wait at the start
+      // position
+      if (c.random_start_positions && j < c.start_index + c.num_agents) {
 
         // Uniform distribution in the world
         state.positions[j] = Point3D<T>(
@@ -876,8 +1282,12 @@ void StateMachine<T>::initEnergy(State<T> &state)
     // Get the class
     AgentClassParameters<T> &c = sp_scaled.getAgentClass(i);
 
-    // Initialize the energy of the agents
+    // Initialize the energy of the agents, free slots hold none
     for (int j=c.start_index; j<c.stop_index; j++){
+      if (j >= c.start_index + c.num_agents){
+        state.energy[j] = 0.0;
+        continue;
+      }
 
       // Set the energy of the agent
       state.energy[j] = c.dist_energy(gen);
@@ -898,9 +1308,52 @@ void StateMachine<T>::updatePositions(const State<T> &state,
     Updating the positions of the agents" << std::endl;
 #endif
 
-  // Update the positions of the agents
+  // Prepare the search memory of all agents for this step, the agents
+  // which search pick their direction by id
+  search_state.update(state, brownian_key);
+
+  // Sort the agents by status and strategy
+  bucketAgents(state);
+
+  // Dead agents and free slots do not move
+  for (int i = 0; i < (int)stay_ids.size(); i++){
+    agents[stay_ids[i]].stay(state, new_state);
+  }
+
+  // Move the other agents, one strategy dispatch per batch
+  for (int b = 0; b < (int)move_batches.size(); b++){
+    const MoveBatch &batch = move_batches[b];
+    Agent<T>::updatePositions(agents, state, new_state, batch.strategy,
+        &move_ids[batch.begin], batch.end - batch.begin);
+  }
+}
+
+template <typename T>
+void StateMachine<T>::bucketAgents(const State<T> &state)
+{
+#ifdef DEBUG
+  std::cout << "StateMachine::bucketAgents: \
+    Sorting the agents by status and strategy" << std::endl;
+#endif
+
+  stay_ids.clear();
+  move_ids.clear();
+  move_batches.clear();
+
+  // The moving agents share the random number generator, their order 
+  // is kept so that the results do not depend on the batching
   for (int i = 0; i < sp_scaled.num_agents_total; i++){
-    agents.at(i).updatePosition(state, new_state);
+    if (!isActive(state.status[i])){
+      stay_ids.push_back(i);
+      continue;
+    }
+    const int strategy = state.strategy[i];
+    if (move_batches.empty() || move_batches.back().strategy != strategy){
+      const int begin = (int)move_ids.size();
+      move_batches.push_back({strategy, begin, begin});
+    }
+    move_ids.push_back(i);
+    move_batches.back().end = (int)move_ids.size();
   }
 }
 
@@ -940,6 +1393,8 @@ void StateMachine<T>::attackFood(const State<T> &state,
     agents[i].energyExchangePartOneRegister(state, new_state);
   }
 
+  // Group the registered exchanges by the agents they were registered at
+  agent_data.groupExchanges();
 }
 
 template <typename T>
@@ -1103,23 +1558,14 @@ void StateMachine<T>::calculateAudibilityAgentToAgent(State<T> &state)
   }
 #endif
 
-  // Calculate the audibility of agents
-#pragma omp for 
-  for (int i=0; i<state.num_agents_total; i++){
-    for (int j=0; j<state.num_agents_total; j++){
-      if (state.distances_agent_to_agent[i*state.num_agents_total+j] 
-          < state.audibility_threshold[j]){
-        state.audibility[i*state.num_agents_total+j] = 1;
-      } else{
-        state.audibility[i*state.num_agents_total+j] = 0;
-      }
-      if (i == j){
-        state.audibility[i*state.num_agents_total+j] = 0;
-      }
-    }
-  }
-  
-} 
+  // Calculate the audibility of agents, agent i hears agent j
+  const State<T> *previous = meta_previous;
+  calculateMaskAgentToAgent(state, state.audibility,
+      previous != NULL ? previous->audibility : NULL,
+      [&state](int i, int j){
+        return state.getDistance(i, j) < state.audibility_threshold[j];
+      });
+}
 
 template <typename T>
 void StateMachine<T>::calculateAudibilityAgentToClass(State<T> &state)
@@ -1143,20 +1589,29 @@ void StateMachine<T>::calculateAudibilityAgentToClass(State<T> &state)
   // how many agents in class i can agent j hear
 
   // Calculate the audibility of agents to classes
-#pragma omp for  
-  for (int j = 0; j < state.num_agents_total; j++){
-    for (int i = 0; i < sp_scaled.num_agent_classes; i++){
-      // Get the class
-      AgentClassParameters<T> &c = sp_scaled.getAgentClass(i);
-      // Calculate indices
-      const int start_index = j * state.num_agents_total + c.start_index; 
-      const int stop_index = j * state.num_agents_total + c.stop_index;
-      // Number of audible agents in class
-      int sum = 0;
-      for (int k = start_index; k < stop_index; k++){
-        sum += state.audibility[k];
+  countAgentToClass(state, state.audibility, state.audibility_agent_to_class);
+
+  // Memory layout of hears_food, bit packed:
+  // a0c0, a1c0, ..., ajc0, ...
+  // a0ci, a1ci, ..., ajci, ...
+  // does agent j hear at least one food source of class i
+  int num_agents = state.num_agents_total;
+  int num_words = state.getNumMaskWords();
+  int mask_pitch = state.getMaskPitch();
+  int pitch = state.getPitch();
+#pragma omp for
+  for (int w = 0; w < num_words; w++){
+    int j0 = w * BITS_PER_WORD;
+    int num_bits = std::min(BITS_PER_WORD, num_agents - j0);
+    for (int c = 0; c < state.num_classes; c++){
+      uint64_t word = 0;
+      for (int f : sp_scaled.getRelationIds(c, RELATION_FOOD)){
+        const int *counts = &state.audibility_agent_to_class[f * pitch];
+        for (int k = 0; k < num_bits; k++){
+          word |= (uint64_t)(counts[j0 + k] > 0) << k;
+        }
       }
-      state.audibility_agent_to_class[i*state.num_agents_total + j] = sum;
+      state.hears_food[c * mask_pitch + w] = word;
     }
   }
 }
@@ -1191,8 +1646,8 @@ void StateMachine<T>::calculateAudibilityClassToClass(State<T> &state)
       AgentClassParameters<T> &d = sp_scaled.getAgentClass(j);
 
       // Calculate indices
-      int start_index = i * state.num_agents_total + d.start_index;
-      int stop_index = i * state.num_agents_total + d.stop_index;
+      int start_index = i * state.getPitch() + d.start_index;
+      int stop_index = i * state.getPitch() + d.stop_index;
 
       // Number of agents in class i that can hear at least 
       // one agent of class j
@@ -1214,19 +1669,207 @@ void StateMachine<T>::calculateDistancesAgentToAgent(State<T> &state)
   }
 #endif
 
-  // Calculate the distances between agents
-#pragma omp for 
-  for (int i = 0; i < sp_scaled.num_agents_total; i++){
+  typedef typename State<T>::distance_type distance_type;
+  const int num_agents = state.num_agents_total;
+  const int pitch = state.getPitch();
+  const State<T> *previous = meta_previous;
+  const uint8_t window = (1 << META_WINDOW) - 1;
+  Point3D<T> period, inv_period;
+  const bool periodic = 
+    initPeriods(sp_scaled.getPeriodicBox(), period, inv_period);
+
+  // Calculate the distances between agents, static schedule like the
+  // first touch of the rows in State::touchArena
+#pragma omp for schedule(static)
+  for (int i = 0; i < num_agents; i++){
+    distance_type *row = &state.distances_agent_to_agent[i*pitch];
+
+    // If agent i did not move, only the distances to the moving agents
+    // differ from the previous row, if it did not move within the 
+    // window the row in memory is still valid except for the agents 
+    // which moved within the window
+    if (previous != NULL && !moved_flags[i]){
+      const std::vector<int> *ids = &window_moving_ids;
+      if (moved_steps[i] & window){
+        const distance_type *previous_row = 
+          &previous->distances_agent_to_agent[i*pitch];
+        std::copy(previous_row, previous_row + num_agents, row);
+        ids = &moving_ids;
+      }
+      for (int k = 0; k < (int)ids->size(); k++){
+        const int j = (*ids)[k];
+        T distance = imageDistance(state.positions[i], state.positions[j],
+            periodic, period, inv_period);
+        row[j] = state.encodeDistance(distance);
+      }
+      continue;
+    }
 
-    // Loop over all agents
-    for (int j = 0; j < sp_scaled.num_agents_total; j++){
-      // Calculate the distance between agents
-      state.distances_agent_to_agent[i*sp_scaled.num_agents_total + j] 
-        = state.positions[i].distance(state.positions[j]);
+    // Loop over all agents, the test for a periodic world stays out of
+    // the loops so that they vectorize
+    const Point3D<T> position = state.positions[i];
+    if (periodic){
+      for (int j = 0; j < num_agents; j++){
+        T distance = 
+          position.distance(state.positions[j], period, inv_period);
+        row[j] = state.encodeDistance(distance);
+      }
+    } else {
+      for (int j = 0; j < num_agents; j++){
+        T distance = position.distance(state.positions[j]);
+        row[j] = state.encodeDistance(distance);
+      }
     }
   }
 }
 
+#ifdef COMPACT_DISTANCES
+template <typename T>
+void StateMachine<T>::calculateCompactDistancesAgentToAgent(State<T> &state)
+{
+#ifdef DEBUG
+  if (p_global.getVerbosity() > 2){
+    std::cout << "StateMachine::calculateCompactDistancesAgentToAgent: \
+      Calculating distances and masks of agents" << std::endl;
+  }
+#endif
+
+  const bool audibility = meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT];
+  const bool reachability = 
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT];
+  const bool contact = meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT];
+
+  // Calculate the distances between agents, store them rounded and
+  // evaluate the predicates on the full precision distance, static 
+  // schedule like the first touch of the rows in State::touchArena
+  const int num_agents = state.num_agents_total;
+  const int num_words = state.getNumMaskWords();
+  const int pitch = state.getPitch();
+  const int mask_pitch = state.getMaskPitch();
+  const State<T> *previous = meta_previous;
+  const uint64_t *alive = alive_bits.data();
+  const uint8_t window = (1 << META_WINDOW) - 1;
+  Point3D<T> period, inv_period;
+  const bool periodic = 
+    initPeriods(sp_scaled.getPeriodicBox(), period, inv_period);
+#pragma omp for schedule(static)
+  for (int i=0; i<num_agents; i++){
+    typename State<T>::distance_type *row = 
+      &state.distances_agent_to_agent[i*pitch];
+    Point3D<T> position = state.positions[i];
+
+    // Dead agents neither perceive nor are perceived
+    const bool alive_i = testBit(alive, i);
+
+    // If agent i did not change, only the entries of the changed agents
+    // differ from the previous row, if it did not change within the 
+    // window the row in memory is still valid except for the agents 
+    // changed within the window
+    if (previous != NULL && !changed_flags[i]){
+      const size_t d = (size_t)i*pitch;
+      const size_t m = (size_t)i*mask_pitch;
+      const std::vector<int> *ids = &window_changed_ids;
+      if (changed_steps[i] & window){
+        std::copy(&previous->distances_agent_to_agent[d],
+            &previous->distances_agent_to_agent[d] + num_agents, row);
+        if (audibility){
+          std::copy(&previous->audibility[m], 
+              &previous->audibility[m] + num_words, &state.audibility[m]);
+        }
+        if (reachability){
+          std::copy(&previous->reachability[m], 
+              &previous->reachability[m] + num_words, 
+              &state.reachability[m]);
+        }
+        if (contact){
+          std::copy(&previous->contact[m], 
+              &previous->contact[m] + num_words, &state.contact[m]);
+        }
+        ids = &changed_ids;
+      }
+      for (int k=0; k<(int)ids->size(); k++){
+        const int j = (*ids)[k];
+        T distance = imageDistance(position, state.positions[j], 
+            periodic, period, inv_period);
+        row[j] = state.encodeDistance(distance);
+        const bool perceived = alive_i && testBit(alive, j);
+        if (audibility){
+          assignBit(&state.audibility[m], j, 
+              perceived && distance < state.audibility_threshold[j]);
+        }
+        if (reachability){
+          assignBit(&state.reachability[m], j, 
+              perceived && distance < state.movespeed[i]);
+        }
+        if (contact){
+          assignBit(&state.contact[m], j, perceived 
+              && distance < (T)0.5 *(state.sizes[i] + state.sizes[j]));
+        }
+      }
+      continue;
+    }
+
+    for (int w=0; w<num_words; w++){
+      const int j0 = w*BITS_PER_WORD;
+      const int n = std::min(BITS_PER_WORD, num_agents - j0);
+
+      // Full precision distances of one word of agents, the closest
+      // image in a periodic world
+      T distance[BITS_PER_WORD];
+      if (periodic){
+        for (int k=0; k<n; k++){
+          distance[k] = position.distance(state.positions[j0 + k], 
+              period, inv_period);
+        }
+      } else {
+        for (int k=0; k<n; k++){
+          distance[k] = position.distance(state.positions[j0 + k]);
+        }
+      }
+      for (int k=0; k<n; k++){
+        row[j0 + k] = state.encodeDistance(distance[k]);
+      }
+
+      // Predicates on the full precision distances
+      const T *threshold = &state.audibility_threshold[j0];
+      const T *sizes = &state.sizes[j0];
+      const T movespeed = state.movespeed[i];
+      const T size = state.sizes[i];
+      uint64_t word_audibility = 0;
+      uint64_t word_reachability = 0;
+      uint64_t word_contact = 0;
+      for (int k=0; k<n; k++){
+        word_audibility |= (uint64_t)(distance[k] < threshold[k]) << k;
+        word_reachability |= (uint64_t)(distance[k] < movespeed) << k;
+        word_contact |= 
+          (uint64_t)(distance[k] < (T)0.5 *(size + sizes[k])) << k;
+      }
+      const uint64_t perceived = alive_i ? alive[w] : 0;
+      if (audibility){
+        state.audibility[i*mask_pitch + w] = word_audibility & perceived;
+      }
+      if (reachability){
+        state.reachability[i*mask_pitch + w] = word_reachability & perceived;
+      }
+      if (contact){
+        state.contact[i*mask_pitch + w] = word_contact & perceived;
+      }
+    }
+
+    // Agents do not perceive themselves
+    if (audibility){
+      clearBit(&state.audibility[i*mask_pitch], i);
+    }
+    if (reachability){
+      clearBit(&state.reachability[i*mask_pitch], i);
+    }
+    if (contact){
+      clearBit(&state.contact[i*mask_pitch], i);
+    }
+  }
+}
+#endif
+
 template <typename T>
 void StateMachine<T>::calculateDistancesAgentToClass(State<T> &state)
 {
@@ -1245,28 +1888,51 @@ void StateMachine<T>::calculateDistancesAgentToClass(State<T> &state)
   // da0cj, da1cj, ..., daicj, ...
   //
 
+  const int num_agents = state.num_agents_total;
+  const int num_classes = sp_scaled.num_agent_classes;
+  const int pitch = state.getPitch();
 
-    // Loop over all agents
-#pragma omp for 
-    for (int i = 0; i < sp_scaled.num_agents_total; i++){
+  // Averages of one tile of agents, class-major like the result
+  std::vector<T> tile(num_classes * AGENT_TO_CLASS_TILE);
 
-      // Loop over all classes
-      for (int j = 0; j < sp_scaled.num_agent_classes; j++){
+  // Loop over tiles of agents
+#pragma omp for schedule(static)
+  for (int i0 = 0; i0 < num_agents; i0 += AGENT_TO_CLASS_TILE){
+    const int i1 = std::min(i0 + AGENT_TO_CLASS_TILE, num_agents);
 
-        // Get the class
-        AgentClassParameters<T> &c = sp_scaled.getAgentClass(j);
+    // One pass over the row of every agent
+    for (int i = i0; i < i1; i++){
+      const typename State<T>::distance_type *row = 
+        &state.distances_agent_to_agent[i * pitch];
 
-        // Calculate indices
-        int start_index = i * state.num_agents_total + c.start_index; 
-        int stop_index = i * state.num_agents_total + c.stop_index;
+      // Loop over all classes
+      for (int j = 0; j < num_classes; j++){
+        const AgentClassParameters<T> &c = sp_scaled.agent_class_params[j];
+
+        // Average of the distances between agent i and 
+        // the alive members of class j, the vacant and dead slots
+        // do not count
+        const int n = class_alive_end[j] - class_alive_begin[j];
+        T sum = 0.0;
+        if (n == c.stop_index - c.start_index){
+#pragma omp simd reduction(+:sum)
+          for (int k = c.start_index; k < c.stop_index; k++){
+            sum += state.decodeDistance(row[k]);
+          }
+        } else {
+          for (int k = class_alive_begin[j]; k < class_alive_end[j]; k++){
+            sum += state.decodeDistance(row[alive_ids[k]]);
+          }
+        }
+        tile[j * AGENT_TO_CLASS_TILE + i - i0] = (n > 0) ? sum / (T)n : 0.0;
+      }
+    }
 
-        // Average distance to class
-        // Calculates the average of the distances between agent i and 
-        // all members of class j
-        state.calculateAverage(
-          state.distances_agent_to_agent,
-          start_index, stop_index, 
-          state.distances_agent_to_class[j*state.num_agents_total + i]);
+    // Write the tile contiguously for every class
+    for (int j = 0; j < num_classes; j++){
+      std::copy(&tile[j * AGENT_TO_CLASS_TILE], 
+          &tile[j * AGENT_TO_CLASS_TILE] + (i1 - i0),
+          &state.distances_agent_to_class[j * pitch + i0]);
     }
   }
 }
@@ -1297,14 +1963,25 @@ void StateMachine<T>::calculateDistancesClassToClass(State<T> &state)
       AgentClassParameters<T> &d = sp_scaled.getAgentClass(j);
 
       // Calculate indices
-      int start_index = i * state.num_agents_total + d.start_index;
-      int stop_index = i * state.num_agents_total + d.stop_index;
+      int start_index = i * state.getPitch() + d.start_index;
+      int stop_index = i * state.getPitch() + d.stop_index;
 
-      // Average distance to class
-      state.calculateAverage(
-        state.distances_agent_to_class,
-        start_index, stop_index, 
-        state.distances_class_to_class[i*num_classes + j]);
+      // Average distance to the alive members of the class
+      const int n = class_alive_end[j] - class_alive_begin[j];
+      if (n == d.stop_index - d.start_index){
+        state.calculateAverage(
+          state.distances_agent_to_class,
+          start_index, stop_index, 
+          state.distances_class_to_class[i*num_classes + j]);
+      } else {
+        T sum = 0.0;
+        for (int k = class_alive_begin[j]; k < class_alive_end[j]; k++){
+          sum += state.distances_agent_to_class[i * state.getPitch() 
+            + alive_ids[k]];
+        }
+        state.distances_class_to_class[i*num_classes + j] = 
+          (n > 0) ? sum / (T)n : 0.0;
+      }
     }
   }
 }
@@ -1319,21 +1996,13 @@ void StateMachine<T>::calculateReachabilityAgentToAgent(State<T> &state)
   }
 #endif
 
-  // Calculate the reachability of agents
-#pragma omp for 
-  for (int i=0; i<state.num_agents_total; i++){
-    for (int j=0; j<state.num_agents_total; j++){
-      if (state.distances_agent_to_agent[i*state.num_agents_total+j] 
-          < state.movespeed[i]){
-        state.reachability[i*state.num_agents_total+j] = 1;
-      } else{
-        state.reachability[i*state.num_agents_total+j] = 0;
-      }
-      if (i == j){
-        state.reachability[i*state.num_agents_total+j] = 0;
-      }
-    }
-  }
+  // Calculate the reachability of agents, agent i reaches agent j
+  const State<T> *previous = meta_previous;
+  calculateMaskAgentToAgent(state, state.reachability,
+      previous != NULL ? previous->reachability : NULL,
+      [&state](int i, int j){
+        return state.getDistance(i, j) < state.movespeed[i];
+      });
 }
 
 template <typename T>
@@ -1353,22 +2022,8 @@ void StateMachine<T>::calculateReachabilityAgentToClass(State<T> &state)
   // a0ci, a1ci, ..., ajci, ...
 
   // Calculate the reachability of agents to classes
-#pragma omp for 
-  for (int j = 0; j < state.num_agents_total; j++){
-    for (int i = 0; i < sp_scaled.num_agent_classes; i++){
-      // Calculate indices
-      // Get the class
-      AgentClassParameters<T> &c = sp_scaled.getAgentClass(i);
-      const int start_index = j * state.num_agents_total + c.start_index; 
-      const int stop_index = j * state.num_agents_total + c.stop_index;
-      // Number of reachable agents in class
-      int sum = 0;
-      for (int k = start_index; k < stop_index; k++){
-        sum += state.reachability[k];
-      }
-      state.reachability_agent_to_class[i*state.num_agents_total + j] = sum;
-    }
-  }
+  countAgentToClass(state, state.reachability, 
+      state.reachability_agent_to_class);
 }
 
 template <typename T>
@@ -1401,8 +2056,8 @@ void StateMachine<T>::calculateReachabilityClassToClass(State<T> &state)
       AgentClassParameters<T> &d = sp_scaled.getAgentClass(j);
 
       // Calculate indices
-      int start_index = i * state.num_agents_total + d.start_index;
-      int stop_index = i * state.num_agents_total + d.stop_index;
+      int start_index = i * state.getPitch() + d.start_index;
+      int stop_index = i * state.getPitch() + d.stop_index;
 
       // Number of agents of class i that can reach at least
       // one agent of class j 
@@ -1425,22 +2080,136 @@ void StateMachine<T>::calculateContactAgentToAgent(State<T> &state)
 #endif
 
   // Calculate the contact of agents
-#pragma omp for  
-  for (int i=0; i<state.num_agents_total; i++){
-    for (int j=0; j<state.num_agents_total; j++){
-      if (state.distances_agent_to_agent[i*state.num_agents_total+j] 
-          < 0.5 *(state.sizes[i]+state.sizes[j])){
-        state.contact[i*state.num_agents_total+j] = 1;
-      } else{
-        state.contact[i*state.num_agents_total+j] = 0;
+  const State<T> *previous = meta_previous;
+  calculateMaskAgentToAgent(state, state.contact,
+      previous != NULL ? previous->contact : NULL,
+      [&state](int i, int j){
+        return state.getDistance(i, j) 
+          < 0.5 *(state.sizes[i]+state.sizes[j]);
+      });
+}
+
+template <typename T>
+void StateMachine<T>::calculateNeighborsAgentToAgent(State<T> &state)
+{
+#ifdef DEBUG
+  if (p_global.getVerbosity() > 2){
+    std::cout << "StateMachine::calculateNeighborsAgentToAgent: \
+      Calculating distances and masks of the neighbors" << std::endl;
+  }
+#endif
+
+  const bool audibility = meta_plan[(int)LogFlags::AUDIBILITY_AGENT_TO_AGENT];
+  const bool reachability = 
+    meta_plan[(int)LogFlags::REACHABILITY_AGENT_TO_AGENT];
+  const bool contact = meta_plan[(int)LogFlags::CONTACT_AGENT_TO_AGENT];
+
+  // All predicates are false beyond the candidates, the masks start 
+  // empty, static schedule like the first touch of the rows in 
+  // State::touchArena
+  const int num_agents = state.num_agents_total;
+  const int num_words = state.getNumMaskWords();
+  const int pitch = state.getPitch();
+  const int mask_pitch = state.getMaskPitch();
+  const uint64_t *alive = alive_bits.data();
+  Point3D<T> period, inv_period;
+  const bool periodic = 
+    initPeriods(sp_scaled.getPeriodicBox(), period, inv_period);
+#pragma omp for schedule(static)
+  for (int i=0; i<num_agents; i++){
+    typename State<T>::distance_type *row = 
+      &state.distances_agent_to_agent[i*pitch];
+    const size_t m = (size_t)i*mask_pitch;
+    if (audibility){
+      std::fill(&state.audibility[m], &state.audibility[m] + num_words, 0);
+    }
+    if (reachability){
+      std::fill(&state.reachability[m], 
+          &state.reachability[m] + num_words, 0);
+    }
+    if (contact){
+      std::fill(&state.contact[m], &state.contact[m] + num_words, 0);
+    }
+
+    // Dead agents neither perceive nor are perceived
+    const bool alive_i = testBit(alive, i);
+    Point3D<T> position = state.positions[i];
+    for (const int *k = neighbor_lists.begin(i); 
+        k != neighbor_lists.end(i); k++){
+      const int j = *k;
+      T distance = imageDistance(position, state.positions[j], 
+          periodic, period, inv_period);
+      row[j] = state.encodeDistance(distance);
+      if (!alive_i || !testBit(alive, j)){
+        continue;
+      }
+      if (audibility && distance < state.audibility_threshold[j]){
+        setBit(&state.audibility[m], j);
       }
-      if (i == j){
-        state.contact[i*state.num_agents_total+j] = 0;
+      if (reachability && distance < state.movespeed[i]){
+        setBit(&state.reachability[m], j);
+      }
+      if (contact && distance < (T)0.5 *(state.sizes[i] + state.sizes[j])){
+        setBit(&state.contact[m], j);
       }
     }
   }
 }
 
+template <typename T>
+template <typename Predicate>
+void StateMachine<T>::calculateMaskAgentToAgent(State<T> &state, 
+    uint64_t *mask, const uint64_t *previous_mask, Predicate hit)
+{
+  // One word of the bit packed row at a time, static schedule like the
+  // first touch of the rows in State::touchArena
+  const int num_agents = state.num_agents_total;
+  const int num_words = state.getNumMaskWords();
+  const int mask_pitch = state.getMaskPitch();
+  const uint64_t *alive = alive_bits.data();
+  const uint8_t window = (1 << META_WINDOW) - 1;
+#pragma omp for schedule(static)
+  for (int i=0; i<num_agents; i++){
+    uint64_t *row = &mask[i*mask_pitch];
+
+    // Dead agents do not perceive
+    if (!testBit(alive, i)){
+      std::fill(row, row + num_words, 0);
+      continue;
+    }
+
+    // Only the bits of the changed agents differ from the previous row
+    // of an unchanged agent, the row in memory is still valid except 
+    // for the agents changed within the window if agent i did not
+    if (previous_mask != NULL && !changed_flags[i]){
+      const std::vector<int> *ids = &window_changed_ids;
+      if (changed_steps[i] & window){
+        const uint64_t *previous_row = &previous_mask[i*mask_pitch];
+        std::copy(previous_row, previous_row + num_words, row);
+        ids = &changed_ids;
+      }
+      for (int k=0; k<(int)ids->size(); k++){
+        const int j = (*ids)[k];
+        assignBit(row, j, testBit(alive, j) && hit(i, j));
+      }
+      continue;
+    }
+
+    for (int w=0; w<num_words; w++){
+      const int j0 = w*BITS_PER_WORD;
+      const int j1 = std::min(j0 + BITS_PER_WORD, num_agents);
+      uint64_t word = 0;
+      for (int j=j0; j<j1; j++){
+        word |= (uint64_t)hit(i, j) << (j - j0);
+      }
+
+      // Dead agents are not perceived
+      row[w] = word & alive[w];
+    }
+    clearBit(row, i);
+  }
+}
+
 template <typename T>
 void StateMachine<T>::calculateContactAgentToClass(State<T> &state)
 {
@@ -1458,21 +2227,42 @@ void StateMachine<T>::calculateContactAgentToClass(State<T> &state)
   // a0ci, a1ci, ..., ajci, ...
 
   // Calculate the contact of agents to classes
-#pragma omp for 
-  for (int j = 0; j < state.num_agents_total; j++){
-    for (int i = 0; i < sp_scaled.num_agent_classes; i++){
-      // Get the class
-      AgentClassParameters<T> &c = sp_scaled.getAgentClass(i);
+  countAgentToClass(state, state.contact, state.contact_agent_to_class);
+}
 
-      // Calculate indices
-      const int start_index = j * state.num_agents_total + c.start_index; 
-      const int stop_index = j * state.num_agents_total + c.stop_index;
-      // Number of contacts with agents in class
-      int sum = 0;
-      for (int k = start_index; k < stop_index; k++){
-        sum += state.contact[k];
+template <typename T>
+void StateMachine<T>::countAgentToClass(const State<T> &state, 
+    const uint64_t *mask, int *counts)
+{
+  const int num_agents = state.num_agents_total;
+  const int num_classes = sp_scaled.num_agent_classes;
+  const int pitch = state.getPitch();
+  const int mask_pitch = state.getMaskPitch();
+
+  // Counts of one tile of agents, class-major like the result
+  std::vector<int> tile(num_classes * AGENT_TO_CLASS_TILE);
+
+  // Loop over tiles of agents
+#pragma omp for schedule(static)
+  for (int j0 = 0; j0 < num_agents; j0 += AGENT_TO_CLASS_TILE){
+    const int j1 = std::min(j0 + AGENT_TO_CLASS_TILE, num_agents);
+
+    // One pass over the row of every agent, the members of a class
+    // are stored contiguously from start_index to stop_index
+    for (int j = j0; j < j1; j++){
+      const uint64_t *row = &mask[j * mask_pitch];
+      for (int i = 0; i < num_classes; i++){
+        const AgentClassParameters<T> &c = sp_scaled.agent_class_params[i];
+        tile[i * AGENT_TO_CLASS_TILE + j - j0] = 
+          countBits(row, c.start_index, c.stop_index);
       }
-      state.contact_agent_to_class[i*state.num_agents_total + j] = sum;
+    }
+
+    // Write the tile contiguously for every class
+    for (int i = 0; i < num_classes; i++){
+      std::copy(&tile[i * AGENT_TO_CLASS_TILE], 
+          &tile[i * AGENT_TO_CLASS_TILE] + (j1 - j0),
+          &counts[i * pitch + j0]);
     }
   }
 }
@@ -1505,8 +2295,8 @@ void StateMachine<T>::calculateContactClassToClass(State<T> &state)
       AgentClassParameters<T> &d = sp_scaled.getAgentClass(j);
 
       // Calculate indices
-      int start_index = i * state.num_agents_total + d.start_index;
-      int stop_index = i * state.num_agents_total + d.stop_index;
+      int start_index = i * state.getPitch() + d.start_index;
+      int stop_index = i * state.getPitch() + d.stop_index;
 
       // Number of agents of class i that are in contact with at least
       // one agent of class j
@@ -1779,6 +2569,9 @@ void StateMachine<T>::loadStateToml(State<T> &state, std::string filename)
   initAgents(state); //must be called after state.loadStateToml
   initAgentClasses();
   initAgentMetrics();
+
+  // The plan of derived quantities depends on the loaded strategies
+  initLogFlags();
   updateMeta(state);
 
 #ifdef DEBUG
@@ -2400,6 +3193,25 @@ State<T> &StateMachine<T>::getState()
   return states[0];
 }
 
+template <typename T>
+void StateMachine<T>::getState(int age, State<T> &state)
+{
+#ifdef DEBUG
+  std::cout << "StateMachine::getState: \
+    Getting the state " << age << " iterations ago" << std::endl;
+#endif
+
+  // Full states are copied, older ones restored from the history
+  if (age >= 0 && age < NUM_FULL_STATES){
+    state = states[age];
+  } else if (age - NUM_FULL_STATES < history.size()){
+    history.restore(age - NUM_FULL_STATES, states[NUM_FULL_STATES-1], 
+        state);
+  } else {
+    handleError("StateMachine::getState: State not in memory", WARNING);
+  }
+}
+
 template <typename T>
 void StateMachine<T>::getDims(T* dims)
 {
@@ -2570,6 +3382,49 @@ T* StateMachine<T>::getAgentClassPointer(State<T> &state, int class_id)
   }
 }
 
+template <typename T>
+T* StateMachine<T>::getAgentClassPositions(int class_id, int &num_points)
+{
+#ifdef DEBUG
+  if (p_global.getVerbosity() > 6){
+    std::cout << "StateMachine::getAgentClassPositions: \
+      Getting the positions of the agents of the class" << std::endl;
+  }
+#endif
+
+  num_points = 0;
+
+  // Return if the class id is out of bounds
+  if (class_id >= sp_scaled.num_agent_classes || class_id < 0){
+    return NULL;
+  }
+
+  // Return if the state is not initialized
+  State<T> &state = states[0];
+  if (state.getInitialized() == false){
+    handleError(
+        "StateMachine::getAgentClassPositions: State not initialized", 
+        WARNING);
+    return NULL;
+  }
+
+  // Copy the agents, the free slots of the class hold none
+  const AgentClassParameters<T> &c = sp_scaled.agent_class_params[class_id];
+  class_positions.resize(sp_scaled.num_agent_classes);
+  std::vector<T> &positions = class_positions[class_id];
+  positions.resize(3*(c.stop_index - c.start_index));
+  for (int i = c.start_index; i < c.stop_index; i++){
+    if (state.status[i] == (int)Status::VACANT){
+      continue;
+    }
+    positions[3*num_points] = state.positions[i].x;
+    positions[3*num_points + 1] = state.positions[i].y;
+    positions[3*num_points + 2] = state.positions[i].z;
+    num_points++;
+  }
+  return positions.data();
+}
+
 template <typename T>
 void StateMachine<T>::swapStates()
 {
@@ -2589,8 +3444,15 @@ void StateMachine<T>::swapStates()
     return;
   }
 
-  // Swap the state of the simulation
-  for (int i = sp_scaled.memory_size-1; i > 0; i--){
+  // Record the step leaving the full states in the history
+  if (states[NUM_FULL_STATES-1].getInitialized()){
+    history.push(states[NUM_FULL_STATES-1], states[NUM_FULL_STATES-2]);
+  }
+
+  // Swap the state of the simulation, the memory of the oldest full 
+  // state is reused for the next state
+  State<T> oldest = std::move(states[NUM_FULL_STATES-1]);
+  for (int i = NUM_FULL_STATES-1; i > 0; i--){
     states[i] = std::move(states[i-1]);
 #ifdef DEBUG
     /*
@@ -2625,8 +3487,14 @@ void StateMachine<T>::swapStates()
   }
   */
 #endif
-  new_state.allocateMemory(sp_scaled.num_agents_total, 
-      sp_scaled.num_agent_classes);
+  new_state = std::move(oldest);
+  new_state.setInitialized(false);
+  if (new_state.positions == NULL 
+      || new_state.num_agents_total != sp_scaled.num_agents_total
+      || new_state.num_classes != sp_scaled.num_agent_classes){
+    new_state.allocateMemory(sp_scaled.num_agents_total, 
+        sp_scaled.num_agent_classes);
+  }
   int iteration = states[0].getIteration();
   iteration++;
   new_state.setIteration(iteration);
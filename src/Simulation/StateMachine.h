@@ -3,6 +3,8 @@
 
 #include <random>
 #include <ctime>
+#include <vector>
+#include <algorithm>
 #include <omp.h>
 
 #include "helpers.h"
@@ -14,7 +16,28 @@
 #include "AgentMetrics.h"
 #include "SystemMetrics.h"
 #include "toml.hpp"
-#include "Search.h"
+#include "SearchState.h"
+#include "StateHistory.h"
+#include "NeighborLists.h"
+#include "Population.h"
+
+// Number of agents per tile of the agent to class reductions
+#define AGENT_TO_CLASS_TILE 64
+
+// Number of states kept in full, older states are kept in the history
+#define NUM_FULL_STATES 2
+
+// The memory of the evicted full state is reused for the next state, 
+// its derived quantities are this many steps older
+#define META_WINDOW (NUM_FULL_STATES + 1)
+
+// The neighbor lists are used while at most one in NEIGHBOR_MAX_FILL 
+// pairs of agents is a candidate, denser lists do not pay
+#define NEIGHBOR_MAX_FILL 16
+
+// Steps between two density checks of neighbor lists which were too 
+// dense, all pairs are calculated in between
+#define NEIGHBOR_RECHECK_INTERVAL 32
 
 enum class LogFlags
 {
@@ -45,6 +68,15 @@ enum class LogFlags
   NUM_LOG_FLAGS
 };
 
+// Consecutive agents sharing a move strategy, indices into the list of 
+// moving agents
+struct MoveBatch
+{
+  int strategy;
+  int begin;
+  int end;
+};
+
 template <typename T>
 class StateMachine
 {
@@ -244,9 +276,18 @@ class StateMachine
   T* getAgentClassPointer(State<T> &state, int class_id);
   T* getAgentClassPointer(int class_id);
 
+  // Get the positions of the agents of a class without the free slots,
+  // num_points is set to their number, the buffer is valid until the
+  // next call for the class
+  T* getAgentClassPositions(int class_id, int &num_points);
+
   // Get the state of the simulation
   State<T> &getState();
 
+  // Get the state age iterations ago, up to memory_size - 1, older states
+  // are restored from the history without derived quantities
+  void getState(int age, State<T> &state);
+
   // Get the dimensions of the simulation
   void getDims(T* dims); 
 
@@ -283,8 +324,13 @@ class StateMachine
 
   // State of the simulation
   State<T> new_state;
+
+  // Current and previous state, read by the transition
   std::vector<State<T>> states;
 
+  // Older states up to the memory size, only the changes per step
+  StateHistory<T> history;
+
   // Agents
   std::vector<Agent<T>> agents;
 
@@ -306,11 +352,86 @@ class StateMachine
   std::uniform_real_distribution<T> dist_y;
   std::uniform_real_distribution<T> dist_z;
 
+  // Key of the counter based generator of the brownian search directions
+  uint64_t brownian_key;
+
+  // Search memory of the agents
+  SearchState<T> search_state;
+
+  // Shared data and per agent fields of the agents
+  AgentData<T> agent_data;
+
   // Log flags
   int log_level;
   bool log_flags[(int)LogFlags::NUM_LOG_FLAGS];
   bool log_state;
 
+  // Derived quantities calculated by updateMeta, indexed by the log flags
+  bool meta_plan[(int)LogFlags::NUM_LOG_FLAGS];
+
+  // Agents bucketed by status and strategy in each iteration,
+  // see bucketAgents
+  std::vector<int> stay_ids;
+  std::vector<int> move_ids;
+  std::vector<MoveBatch> move_batches;
+
+  // Agents compacted in each updateMeta, see compactAgents: the alive
+  // agents, the agents which moved and the agents whose inputs of the
+  // agent to agent kernels changed since the previous state
+  std::vector<int> alive_ids;
+  std::vector<int> moving_ids;
+  std::vector<int> changed_ids;
+
+  // Range of the alive members of every class in alive_ids, the averages
+  // over a class only count its alive members
+  std::vector<int> class_alive_begin;
+  std::vector<int> class_alive_end;
+
+  // Flags of the lists above per agent, alive agents bit packed
+  std::vector<char> moved_flags;
+  std::vector<char> changed_flags;
+  std::vector<uint64_t> alive_bits;
+
+  // Dirty tracking over the last steps, bit k of an agent is set if it 
+  // moved, changed, k steps ago, all bits are set after a full update
+  std::vector<uint8_t> moved_steps;
+  std::vector<uint8_t> changed_steps;
+
+  // Agents which moved, changed, within the last META_WINDOW steps, 
+  // the rows of the other agents are still valid in the memory of the 
+  // state being updated
+  std::vector<int> window_moving_ids;
+  std::vector<int> window_changed_ids;
+
+  // Previous state of the incremental agent to agent kernels, NULL if
+  // all rows are calculated
+  const State<T> *meta_previous;
+
+  // The derived quantities of the current state follow the plan, the
+  // next updateMeta can take unchanged rows from it
+  bool meta_reusable;
+
+  // Candidate pairs of the agent to agent kernels, used if the skin is
+  // positive and the plan needs no distances of other pairs, see 
+  // initMetaPlan, while the lists are not too dense; dense lists are
+  // checked again after neighbor_recheck steps
+  NeighborLists<T> neighbor_lists;
+  bool use_neighbor_lists;
+  bool neighbors_dense;
+  int neighbor_recheck;
+
+  // Free slots of the classes and the agents moved by the last 
+  // compaction, see updatePopulation
+  Population<T> population;
+  std::vector<std::pair<int, int>> population_moves;
+
+  // Positions of the agents of every class, see getAgentClassPositions
+  std::vector<std::vector<T>> class_positions;
+
+  // The agent to agent rows of the current state were calculated from 
+  // the neighbor lists and lack the other pairs
+  bool meta_neighbors;
+
   // Initialized flag
   bool initialized;
 
@@ -340,6 +461,9 @@ class StateMachine
   // Init log flags
   void initLogFlags();
 
+  // Init the plan of derived quantities, call after initLogFlags
+  void initMetaPlan();
+
   // Initialize the parameters
   void initParameters();
 
@@ -382,6 +506,10 @@ class StateMachine
   // Update the positions of the agents
   void updatePositions(const State<T> &state, State<T> &new_state);
 
+  // Sort the agents into agents which stay and batches of moving agents
+  // with the same strategy, keeping the order of the moving agents
+  void bucketAgents(const State<T> &state);
+
   // Update the energy of the agents
   void updateEnergy(const State<T> &state, State<T> &new_state);
   void updateEnergyConsumptionRateTime(const State<T> &state, 
@@ -411,6 +539,10 @@ class StateMachine
   // Update the status of the agents
   void updateStatus(const State<T> &state, State<T> &new_state);
 
+  // Free the slots of the agents which died without respawn, let the
+  // agents with enough energy reproduce and compact the classes
+  void updatePopulation(const State<T> &state, State<T> &new_state);
+
 
   /* Update meta functions */
 
@@ -419,8 +551,32 @@ class StateMachine
   void calculateAudibilityAgentToClass(State<T> &state);
   void calculateAudibilityClassToClass(State<T> &state);
 
+  // Sizes of a periodic world of half sizes box and their inverses, 0
+  // along an axis without extent, returns false if box is NULL
+  bool static initPeriods(const T *box, Point3D<T> &period, 
+      Point3D<T> &inv_period)
+  {
+    if (box == NULL){
+      return false;
+    }
+    Point3D<T>::periods(box, period, inv_period);
+    return true;
+  }
+
+  // Distance between two positions, the closest image in a periodic
+  // world of the given periods, see initPeriods
+  T static imageDistance(const Point3D<T> &p, const Point3D<T> &q, 
+      bool periodic, const Point3D<T> &period, const Point3D<T> &inv_period)
+  {
+    return periodic ? p.distance(q, period, inv_period) : p.distance(q);
+  }
+
   // Calculate distances between agents
   void calculateDistancesAgentToAgent(State<T> &state);
+#ifdef COMPACT_DISTANCES
+  // Calculate the rounded distances and the masks agent to agent at once
+  void calculateCompactDistancesAgentToAgent(State<T> &state);
+#endif
   void calculateDistancesAgentToClass(State<T> &state);
   void calculateDistancesClassToClass(State<T> &state);
 
@@ -434,8 +590,29 @@ class StateMachine
   void calculateContactAgentToClass(State<T> &state);
   void calculateContactClassToClass(State<T> &state);
 
-  // Update the metadata of the state
-  void updateMeta(State<T> &state);
+  // Calculate the distances and masks agent to agent of the candidate
+  // pairs of the neighbor lists, the other distances are not written
+  void calculateNeighborsAgentToAgent(State<T> &state);
+
+  // Calculate a bit packed mask agent to agent, hit(i, j) is the 
+  // predicate, rows of unchanged agents start from previous_mask if it 
+  // is not NULL, dead agents neither perceive nor are perceived
+  template <typename Predicate>
+  void calculateMaskAgentToAgent(State<T> &state, uint64_t *mask,
+      const uint64_t *previous_mask, Predicate hit);
+
+  // Count the set bits of every agent's row per class, tiled
+  void countAgentToClass(const State<T> &state, const uint64_t *mask, 
+      int *counts);
+
+  // Sort the agents of state into the alive, moving and changed lists, 
+  // compared to previous, all agents moved and changed if it is NULL
+  void compactAgents(const State<T> &state, const State<T> *previous);
+
+  // Update the metadata of the state, rows of the agent to agent 
+  // kernels of unchanged agents are taken from previous if it is not 
+  // NULL, its derived quantities must follow the current plan
+  void updateMeta(State<T> &state, const State<T> *previous = NULL);
   
 
   /* Other functions */
@@ -1,29 +1,9 @@
 #include "Agent.h"
+#include "MoveStrategies.h"
 
 template <typename T>
-Agent<T>::Agent(int id, 
-    int verbosity, 
-    SimulationParameters<T> &sim_params,
-    std::vector<Agent<T>> &agents,
-    std::vector<AgentClass<T>> &agent_classes,
-    AgentMetrics<T> &agent_metrics,
-    std::mt19937 &gen,
-    std::uniform_real_distribution<T> &dist_uni,
-    std::uniform_real_distribution<T> &dist_x,
-    std::uniform_real_distribution<T> &dist_y,
-    std::uniform_real_distribution<T> &dist_z)
-  : id(id), sim_params(sim_params), 
-  agents(agents), agent_classes(agent_classes), 
-  agent_metrics(agent_metrics),
-  verbosity(verbosity), gen(gen), 
-  dist_uni(dist_uni), dist_x(dist_x), dist_y(dist_y), dist_z(dist_z),
-  search_memory(id, gen, 
-      dist_uni, dist_x, dist_y, dist_z,
-      0.0, // mu_levy
-      0.0, // c_levy
-      0.0, // brownian_search_duration
-      sim_params.getWorldsize()),
-  transition_state(Status::ALIVE)
+Agent<T>::Agent(int id, AgentData<T> &data)
+  : id(id), data(data)
 {
 #ifdef DEBUG
   /*
@@ -48,28 +28,76 @@ template <typename T>
 void Agent<T>::init(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::init: \
       Initializing the agent" << std::endl;
   }
 #endif
 
   // Initialize the search memory
-  initSearch(state.class_id[id], sim_params, gen);
+  initSearch(state.class_id[id]);
 }
 
 template <typename T>
 void Agent<T>::updatePosition(const State<T> &state, State<T> &new_state)
+{
+  updatePositionStrategy<DYNAMIC_STRATEGY>(state, new_state);
+}
+
+template <typename T>
+void Agent<T>::updatePositions(std::vector<Agent<T>> &agents, 
+    const State<T> &state, State<T> &new_state, 
+    int strategy, const int *ids, int num_ids)
+{
+#ifdef DEBUG
+  if (agents.size() > 0 && agents[0].data.verbosity > 3){
+    std::cout << "Agent::updatePositions: \
+      Updating the positions of " << num_ids << " agents with strategy " 
+      << strategy << std::endl;
+  }
+#endif
+
+  // Select the kernel of the registered strategy
+  bool registered = dispatchStrategy(strategy, [&](auto s){
+      updatePositionsStrategy<decltype(s)::value>(
+          agents, state, new_state, ids, num_ids);
+      });
+
+  // Unknown strategies are reported per agent by createMove
+  if (!registered){
+    updatePositionsStrategy<DYNAMIC_STRATEGY>(
+        agents, state, new_state, ids, num_ids);
+  }
+}
+
+template <typename T>
+template <int strategy>
+void Agent<T>::updatePositionsStrategy(std::vector<Agent<T>> &agents, 
+    const State<T> &state, State<T> &new_state, 
+    const int *ids, int num_ids)
+{
+  // Update the agents of the batch in order, they share the random
+  // number generator
+  for (int k = 0; k < num_ids; k++){
+    agents[ids[k]].template updatePositionStrategy<strategy>(
+        state, new_state);
+  }
+}
+
+template <typename T>
+template <int strategy>
+void Agent<T>::updatePositionStrategy(const State<T> &state, 
+    State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updatePosition: \
       Updating the position of the agent" << std::endl;
   }
 #endif
 
-  // If the agent is dead, no movement
-  if (state.status[id] == (int)Status::DEAD){
+  // If the agent is dead or its slot is free, no movement
+  if (!isActive(state.status[id])){
     stay(state, new_state);
     return;
   }
@@ -77,7 +105,7 @@ void Agent<T>::updatePosition(const State<T> &state, State<T> &new_state)
   // If the agent is attacked, no movement
   if (state.status[id] == (int)Status::ATTACKED){
 #ifdef DEBUG
-  if (verbosity > 2){
+  if (data.verbosity > 2){
     std::cout << "Agent::updatePosition: \
       Agent " << id << " is attacked" << std::endl;
   }
@@ -86,26 +114,26 @@ void Agent<T>::updatePosition(const State<T> &state, State<T> &new_state)
     if (enemyAudible(state)){
       stay(state, new_state);
 #ifdef DEBUG
-  if (verbosity > 2){
+  if (data.verbosity > 2){
       std::cout << "Agent::updatePosition: \
         Agent " << id << " not moving due to attack" << std::endl;
   }
 #endif
       return;
     } else {
-      transition_state = Status::ALIVE;
+      data.transition_state[id] = Status::ALIVE;
     }
   }
 
   // Create move
-  Point3D<T> move = createMove(state);
+  Point3D<T> move = createMoveStrategy<strategy>(state);
 
   // Apply boundary control
   Point3D<T> pos = state.positions[id] + move;
   boundaryControl(pos);
 
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updatePosition: \
       Agent: " << id << " Move: " << move.toString() << std::endl;
     std::cout << "Agent::updatePosition: \
@@ -121,7 +149,7 @@ template <typename T>
 void Agent<T>::updateMovespeed(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateMovespeed: \
       Updating the movement speed of the agent" << std::endl;
   }
@@ -135,7 +163,7 @@ template <typename T>
 void Agent<T>::updateSize(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateSize: \
       Updating the size of the agent" << std::endl;
   }
@@ -149,7 +177,7 @@ template <typename T>
 void Agent<T>::updateClassId(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateClassId: \
       Updating the class id of the agent" << std::endl;
   }
@@ -168,7 +196,7 @@ void Agent<T>::updateClassId(const State<T> &state, State<T> &new_state)
   // Refresh search memory 
   /*
   if (old_class_id != state.class_id[id]){
-    initSearch(state.class_id[id], sim_params, gen);
+    initSearch(state.class_id[id]);
   }
   */
 }
@@ -177,7 +205,7 @@ template <typename T>
 void Agent<T>::updateStrategy(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateStrategy: \
       Updating the strategy of the agent" << std::endl;
   }
@@ -191,21 +219,31 @@ template <typename T>
 void Agent<T>::updateStatus(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateStatus: \
       Updating the status of the agent" << std::endl;
   }
 #endif
 
-  // Respawn if the agent died in the transition
-  if (transition_state == Status::DEAD){
+  // Free slots stay free until a birth takes them
+  if (state.status[id] == (int)Status::VACANT){
+    new_state.status[id] = state.status[id];
+    return;
+  }
+
+  // Respawn if the agent died in the transition, else free its slot
+  if (data.transition_state[id] == Status::DEAD){
     int class_id = state.class_id[id];
-    respawn(state, new_state, class_id);
-  } else if (transition_state == Status::ATTACKED){
+    if (data.sim_params.agent_class_params[class_id].respawn){
+      respawn(state, new_state, class_id);
+    } else {
+      vacate(new_state);
+    }
+  } else if (data.transition_state[id] == Status::ATTACKED){
     new_state.status[id] = (int)Status::ATTACKED;
   } else {
     new_state.status[id] = state.status[id];
-    transition_state = (Status)state.status[id];
+    data.transition_state[id] = (Status)state.status[id];
   }
 }
 
@@ -214,7 +252,7 @@ void Agent<T>::updateAudibilityThreshold(const State<T> &state,
     State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateAudibilityThreshold: \
       Updating the audibility threshold of the agent" << std::endl;
   }
@@ -229,7 +267,7 @@ void Agent<T>::updateEnergyConsumptionRateTime(
     const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateEnergyConsumptionRateTime: \
       Updating the energy consumption rate per time step of the agent" 
       << std::endl;
@@ -246,7 +284,7 @@ void Agent<T>::updateEnergyConsumptionRateDistance(
     const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateEnergyConsumptionRateDistance: \
       Updating the energy consumption rate per distance of the agent" 
       << std::endl;
@@ -262,7 +300,7 @@ void Agent<T>::updateEnergyUptakeRate(
     const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateEnergyUptakeRate: \
       Updating the energy uptake rate of the agent" << std::endl;
   }
@@ -276,20 +314,28 @@ template <typename T>
 void Agent<T>::updateEnergy(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateEnergy: \
       Updating the energy of the agent" << std::endl;
   }
 #endif
 
+  // Free slots hold no energy
+  if (state.status[id] == (int)Status::VACANT){
+    new_state.energy[id] = state.energy[id];
+    return;
+  }
+
   // Calculate the energy consumed by time
-  T dt = sim_params.getDt();
+  T dt = data.sim_params.getDt();
   T dE_t = dt * state.energy_consumption_per_time[id];
 
   // Calculate the energy consumed by distance
   // ATTENTION: This is uses the new position, thus make sure to call
-  // updatePosition before updateEnergy
-  T ds = state.positions[id].distance(new_state.positions[id]);
+  // updatePosition before updateEnergy, in a periodic world the agent 
+  // may have left it on the other side
+  T ds = state.positions[id].distance(state.positions[id].image(
+        new_state.positions[id], data.sim_params.getPeriodicBox()));
   T dE_s = ds * state.energy_consumption_per_distance[id];
 
   // Update the energy of the agent
@@ -303,9 +349,9 @@ void Agent<T>::updateEnergy(const State<T> &state, State<T> &new_state)
   T dE = dE_t + dE_s;
 
   // Keep track of dissipated energy
-  agent_metrics.energy_removed_from_system[id] += dE;
+  data.agent_metrics.energy_removed_from_system[id] += dE;
 
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::updateEnergy: \
       Agent " << id << " consumed " << dE << " energy" << std::endl;
     std::cout << "Agent::updateEnergy: \
@@ -320,10 +366,10 @@ void Agent<T>::updateEnergy(const State<T> &state, State<T> &new_state)
 
   if (new_energy < DEATH_THRESHOLD){
     // Agent died
-    energy_exchange_register.clear();
-    transition_state = Status::DEAD;
+    data.clearExchanges(id);
+    data.transition_state[id] = Status::DEAD;
 #ifdef DEBUG
-    agent_metrics.energy_removed_from_system[id] += new_energy;
+    data.agent_metrics.energy_removed_from_system[id] += new_energy;
 #endif
   } 
 
@@ -339,15 +385,15 @@ void Agent<T>::energyExchangePartOneRegister(const State<T> &state,
   }
 
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::energyExchangePartOneRegister: \
       Registering for energy exchange" << std::endl;
   }
 #endif
 
-  // Get vector of food source class ids
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
+  // Food source class ids
+  const std::vector<int> &food_source_ids = 
+    data.sim_params.getRelationIds(state.class_id[id], RELATION_FOOD);
 
   // Drops out after first successful registration, this way,
   // food sources are prioritized in the order they are given in
@@ -355,21 +401,22 @@ void Agent<T>::energyExchangePartOneRegister(const State<T> &state,
 
   // Loop over food classes
   for (int i = 0; i < food_source_ids.size(); i++){
+    int class_id = food_source_ids[i];
     // Get the id of the closest food source
     if (numFoodContact(state) > 0){
-      int food_source_id = findClosestContact(state, food_source_ids[i]);
+      int food_source_id = findClosestContact(state, class_id);
       if (food_source_id > -1){
         // Register for energy exchange at the food source
-        agents[food_source_id].registerForEnergyExchange(id, 
+        data.agents[food_source_id].registerForEnergyExchange(id, 
             state.energy_uptake_rate[id]);
         break;
       }
     } else {
-      int food_source_id = findClosestReachable(state, food_source_ids[i]);
+      int food_source_id = findClosestReachable(state, class_id);
       if (food_source_id > -1){
         // Set the status of the food source to attacked, 
         // this will immobilize the food source
-        agents[food_source_id].setTransitionState(Status::ATTACKED);
+        data.agents[food_source_id].setTransitionState(Status::ATTACKED);
         break;
       }
     }
@@ -381,21 +428,24 @@ void Agent<T>::energyExchangePartTwoDistribute(const State<T> &state,
     State<T> &new_state)
 {
   // Return if the energy exchange register is empty
-  if (energy_exchange_register.empty()){
+  const int num_exchanges = data.exchange_count[id];
+  if (num_exchanges == 0){
     return;
   }
 
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::energyExchangePartTwoDistribute: \
       Distributing energy" << std::endl;
   }
 #endif
 
   // Calculate the sum of requested energy
+  const std::pair<int, T> *exchanges = 
+    &data.exchange_pairs[data.exchange_offset[id]];
   T sum_requested_energy = 0.0;
-  for (int i = 0; i < energy_exchange_register.size(); i++){
-    sum_requested_energy += energy_exchange_register[i].second;
+  for (int i = 0; i < num_exchanges; i++){
+    sum_requested_energy += exchanges[i].second;
   }
 
   // Make sure the sum of requested energy is positive
@@ -409,7 +459,7 @@ void Agent<T>::energyExchangePartTwoDistribute(const State<T> &state,
   if (state.energy[id] < sum_requested_energy){
     ratio = state.energy[id] / sum_requested_energy;
 #ifdef DEBUG
-    if (verbosity > 3){
+    if (data.verbosity > 3){
       std::cout << "Agent::energyExchangePartTwoDistribute: \
         Agent " << id << " has less energy than requested" << std::endl;
       std::cout << "Agent::energyExchangePartTwoDistribute: \
@@ -419,12 +469,12 @@ void Agent<T>::energyExchangePartTwoDistribute(const State<T> &state,
   }
 
   // Distribute the energy
-  for (int i = 0; i < energy_exchange_register.size(); i++){
-    int other_id = energy_exchange_register[i].first;
-    double amount = (double)energy_exchange_register[i].second;
+  for (int i = 0; i < num_exchanges; i++){
+    int other_id = exchanges[i].first;
+    double amount = (double)exchanges[i].second;
     amount *= ratio;
 #ifdef DEBUG
-    if (verbosity > 3){
+    if (data.verbosity > 3){
       std::cout << "Agent::energyExchangePartTwoDistribute: \
         Agent " << id << " giving " << amount << 
         " energy to agent " << other_id << std::endl;
@@ -435,27 +485,27 @@ void Agent<T>::energyExchangePartTwoDistribute(const State<T> &state,
 
   // Test if the agent died
   if (new_state.energy[id] < DEATH_THRESHOLD){
-    transition_state = Status::DEAD;
+    data.transition_state[id] = Status::DEAD;
 #ifdef DEBUG
-    agent_metrics.energy_removed_from_system[id] += new_state.energy[id];
+    data.agent_metrics.energy_removed_from_system[id] += new_state.energy[id];
 #endif
   } 
 
   // Clear the energy exchange register
-  energy_exchange_register.clear();
+  data.clearExchanges(id);
 }
 
 template <typename T>
 void Agent<T>::registerForEnergyExchange(int &other_id, T &amount)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::registerForEnergyExchange: \
       Agent " << id << " registering exchange of " 
       << amount << " energy to agent " << other_id << std::endl;
   }
 #endif
-  energy_exchange_register.push_back(std::make_pair(other_id, amount));
+  data.registerExchange(id, other_id, amount);
 }
 
 
@@ -464,7 +514,7 @@ template <typename T>
 void Agent<T>::printId(std::ostream &os)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::printId: \
       Printing the id of the agent" << std::endl;
   }
@@ -477,7 +527,7 @@ template <typename T>
 void Agent<T>::printState(const State<T> &state, std::ostream &os)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::printState: \
       Printing the state of the agent" << std::endl;
   }
@@ -505,7 +555,7 @@ template <typename T>
 Point3D<T> Agent<T>::createMove(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::createMove: \
       Creating a move for the agent" << std::endl;
   }
@@ -516,301 +566,58 @@ Point3D<T> Agent<T>::createMove(const State<T> &state)
     return (Point3D<T>(0.0, 0.0, 0.0));
   }
 
-  switch (state.strategy[id])
-  {
-    case 0:
-      return moveStrategy0(state);
-
-    case 1:
-      return moveStrategy1(state);
-
-    case 2:
-      return moveStrategy2(state);
-
-    case 3:
-      return moveStrategy3(state);
-
-    case 4:
-      return moveStrategy4(state);
-
-    case 5:
-      return moveStrategy5(state);
-
-    case 6:
-      return moveStrategy6(state);
-
-    case 7:
-      return moveStrategy7(state);
-
-    case 8:
-      return moveStrategy8(state);
-
-    default:
-      std::cerr << "Agent::createMove: \
-        Move strategy " << state.strategy[id] << " not implemented" 
-        << std::endl;
-      return Point3D<T>(0.0, 0.0, 0.0);
-  }
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy0(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy0: \
-      Moving agent " << id << " according to strategy 0" << std::endl;
-  }
-#endif
-
-  // No movement
-  return (Point3D<T>(0.0, 0.0, 0.0));
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy1(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy1: \
-      Moving agent " << id << " according to strategy 1" << std::endl;
-  }
-#endif
-
-  /* No communication, only search and approach food */
-
-  // If at food source, stay
-  if (foodContact(state)){
-    return (Point3D<T>(0.0, 0.0, 0.0));
-  }
-
-  // Approach food sources, if some are known
-  if (foodAudible(state)){
-    return approachClosestFoodSource(state);
-  }
-
-  // Search, if no other strategy applies
-  return search(state);
-  
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy2(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy2: \
-      Moving agent " << id << " according to strategy 2" << std::endl;
-  }
-#endif
-
-  /* Communicate food sources, search and approach food */
-
-  // If at food source, stay
-  if (foodContact(state)){
-#ifdef DEBUG
-    std::cout << "Agent::moveStrategy2: \
-      Agent " << id << " is at food source" << std::endl;
-#endif
-    return (Point3D<T>(0.0, 0.0, 0.0));
-  }
-
-  // Approach food sources, if some are known
-  if (foodAudible(state)){
-#ifdef DEBUG
-    std::cout << "Agent::moveStrategy2: \
-      Agent " << id << " is approaching food source" << std::endl;
-#endif
-    return approachClosestFoodSource(state);
-  }
-
-  // If no food sources are known, approach friends which hear food
-  if (friendAudible(state)){
-    Point3D<T> move;
-    move = approachClosestFriendsHearingFood(state);
-    if (!move.isZero()){
-#ifdef DEBUG
-    std::cout << "Agent::moveStrategy2: \
-      Agent " << id << " is approaching friends" << std::endl;
-#endif
-      return move;
-    }
-  }
-
-  // Search, if no other strategy applies
-#ifdef DEBUG
-  std::cout << "Agent::moveStrategy2: \
-    Agent " << id << " is searching" << std::endl;
-#endif
-  return search(state);
-
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy3(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy3: \
-      Moving agent " << id << " according to strategy 3" << std::endl;
-  }
-#endif
-
-  // Avoid enemies, communicate food sources, search and approach food
-
-  // If attacked by enemy, no movement
-  if (attacked(state)){
-    return (Point3D<T>(0.0, 0.0, 0.0));
-  } 
-  
-  // If enemy is audible, avoid
-  if (enemyAudible(state)){
-    return avoidClosestEnemies(state);
-  }
-
-  // If no enemies are audible, move according to strategy 2
-  return moveStrategy2(state);
-
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy4(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy4: \
-      Moving agent " << id << " according to strategy 4" << std::endl;
-  }
-#endif
-
-  // Not yet fully implemented, needs to compare old and new state to
-  // avoid infinite loops
-
-  // If at food source, stay
-  if (foodContact(state)){
-    return (Point3D<T>(0.0, 0.0, 0.0));
-  }
-
-  // Approach food sources, if some are known
+  // Select the registered strategy
   Point3D<T> move(0.0, 0.0, 0.0);
-  if (foodAudible(state)){
-    move = approachClosestFoodSource(state);
-    return (move);
-  }
-  
-  // If friends are audible
-  if (friendAudible(state)){
-
-    // Approach friends which hear food
-    move = approachClosestFriendsHearingFood(state);
-
-    // If no friends hear food
-    if (move.isZero()){
-
-      // If friends are reachable, search
-      if (friendReachable(state)){
-        move = search(state);
-
-      } else {
-
-      // If no friends are reachable, approach audible friends
-        move = approachClosestFriends(state);
-      }
-
-    }
-
-    return move;
+  bool registered = dispatchStrategy(state.strategy[id], [&](auto strategy){
+      move = MoveStrategyAt<decltype(strategy)::value>::move(*this, state);
+      });
+  if (!registered){
+    std::cerr << "Agent::createMove: \
+      Move strategy " << state.strategy[id] << " not implemented" 
+      << std::endl;
   }
-
-  // If no friends are audible, search
-  move = search(state);
   return move;
-  
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy5(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy5: \
-      Moving agent " << id << " according to strategy 5" << std::endl;
-  }
-#endif
-
-  // Avoid enemies only 
-  if (enemyAudible(state)){
-    return avoidClosestEnemies(state);
-  } else {
-    return Point3D<T>(0.0, 0.0, 0.0);
-  }
 }
 
 template <typename T>
-Point3D<T> Agent<T>::moveStrategy6(const State<T> &state)
+template <int strategy>
+Point3D<T> Agent<T>::createMoveStrategy(const State<T> &state)
 {
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy6: \
-      Moving agent " << id << " according to strategy 6" << std::endl;
-  }
-#endif
-
-  // Avoid enemies, search food
-  if (enemyAudible(state)){
-    return avoidClosestEnemies(state);
+  if constexpr (strategy == DYNAMIC_STRATEGY){
+    return createMove(state);
   } else {
-    return moveStrategy1(state);
-  }
-}
-
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy7(const State<T> &state)
-{
 #ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy7: \
-      Moving agent " << id << " according to strategy 7" << std::endl;
-  }
+    if (data.verbosity > 3){
+      std::cout << "Agent::createMoveStrategy: \
+        Creating a move for the agent with strategy " << strategy 
+        << std::endl;
+    }
 #endif
 
-  // Move randomly
-  return randomMove(state);
-}
+    // Return if the movespeed is zero
+    if (nearlyEqual(state.movespeed[id], (T)0.0)) {
+      return (Point3D<T>(0.0, 0.0, 0.0));
+    }
 
-template <typename T>
-Point3D<T> Agent<T>::moveStrategy8(const State<T> &state)
-{
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::moveStrategy8: \
-      Moving agent " << id << " according to strategy 8" << std::endl;
+    return MoveStrategyAt<strategy>::move(*this, state);
   }
-#endif
-
-  // Move randomly, using search memory
-  return search(state);
 }
 
 template <typename T>
 Point3D<T> Agent<T>::approachClosestFoodSource(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::approachClosestFoodSource: \
       Approaching food sources" << std::endl;
   }
 #endif
-  // Get vector of food sources
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
-
-
   // Approach the closest food source
   T scale = getSpeedFactorApproachFood(state);
-  Point3D<T> move = approachClosest(state, food_source_ids, scale);
+  int target_id = findClosestRelation(state, RELATION_FOOD, AWARENESS_AWARE);
+  Point3D<T> move = approachTarget(state, target_id, scale);
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::approachClosestFoodSource: \
       Agent: " << id << " Move: " << move.toString() << std::endl;
   }
@@ -821,15 +628,13 @@ Point3D<T> Agent<T>::approachClosestFoodSource(const State<T> &state)
 template <typename T>
 Point3D<T> Agent<T>::approachClosestFriends(const State<T> &state)
 {
-  // Get vector of friends
-  std::vector<int> friend_ids 
-    = sim_params.getFriendIds(state.class_id[id]);
-
   // Approach friends
   T scale = getSpeedFactorApproachFriends(state);
-  Point3D<T> move = approachClosest(state, friend_ids, scale);
+  int target_id = 
+    findClosestRelation(state, RELATION_FRIEND, AWARENESS_AWARE);
+  Point3D<T> move = approachTarget(state, target_id, scale);
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::approachClosestFriends: \
       Approaching friends" << std::endl;
     std::cout << "Agent::approachClosestFriends: \
@@ -843,25 +648,25 @@ template <typename T>
 Point3D<T> Agent<T>::approachClosestFriendsHearingFood(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::approachClosestFriendsHearingFood: \
       Approaching friends which hear food" << std::endl;
   }
 #endif
 
-  // Get vector of friends
-  std::vector<int> friend_ids 
-    = sim_params.getFriendIds(state.class_id[id]);
+  // Friend classes
+  const std::vector<int> &friend_ids = 
+    data.sim_params.getRelationIds(state.class_id[id], RELATION_FRIEND);
 
-  // Get vector of food sources
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
+  // Agents which hear a food source of the own class
+  const uint64_t *hears_food = 
+    &state.hears_food[state.class_id[id] * state.getMaskPitch()];
 
   // Approach friends
   T scale = getSpeedFactorApproachFriends(state);
-  Point3D<T> move = approachClosest(state, friend_ids, food_source_ids, scale);
+  Point3D<T> move = approachClosest(state, friend_ids, hears_food, scale);
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::approachClosestFriendsHearingFood: \
       Agent: " << id << " Move: " << move.toString() << std::endl;
   }
@@ -872,15 +677,12 @@ Point3D<T> Agent<T>::approachClosestFriendsHearingFood(const State<T> &state)
 template <typename T>
 Point3D<T> Agent<T>::avoidClosestEnemies(const State<T> &state)
 {
-  // Get vector of enemies
-  std::vector<int> enemy_ids 
-    = sim_params.getEnemyIds(state.class_id[id]);
-
   // Avoid enemies
   T scale = getSpeedFactorAvoidEnemies(state);
-  Point3D<T> move = avoidClosest(state, enemy_ids, scale);
+  int target_id = findClosestRelation(state, RELATION_ENEMY, AWARENESS_AWARE);
+  Point3D<T> move = avoidTarget(state, target_id, scale);
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::avoidClosestEnemies: \
       Avoiding enemies" << std::endl;
     std::cout << "Agent::avoidClosestEnemies: \
@@ -894,15 +696,14 @@ template <typename T>
 Point3D<T> Agent<T>::search(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::search: \
       Searching" << std::endl;
   }
 #endif
   
   // Continue search
-  search_memory.determineSearchType(state);
-  Point3D<T> move = search_memory.getDirection(state);
+  Point3D<T> move = data.search_state.getDirection(state, id);
   move *= state.movespeed[id] * getSpeedFactorSearch(state);
   return move;
 }
@@ -911,7 +712,7 @@ template <typename T>
 Point3D<T> Agent<T>::stay()
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::stay: \
       Staying" << std::endl;
   }
@@ -924,7 +725,7 @@ template <typename T>
 void Agent<T>::stay(const State<T> &state, State<T> &new_state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::stay: \
       Staying" << std::endl;
   }
@@ -937,7 +738,7 @@ template <typename T>
 Point3D<T> Agent<T>::randomMove(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::randomMove: \
       Moving randomly" << std::endl;
   }
@@ -945,13 +746,13 @@ Point3D<T> Agent<T>::randomMove(const State<T> &state)
 
   // Creates a random move with equal probability in all directions
   // of random length between 0 and the movespeed of the agent
-  T x = dist_x(gen);
-  T y = dist_y(gen);
-  T z = dist_z(gen);
+  T x = data.dist_x(data.gen);
+  T y = data.dist_y(data.gen);
+  T z = data.dist_z(data.gen);
 
   Point3D<T> move(x, y, z);
   move.normalize();
-  move *= state.movespeed[id] * dist_uni(gen);
+  move *= state.movespeed[id] * data.dist_uni(data.gen);
   return move;
 }
 
@@ -960,13 +761,13 @@ template<typename T>
 T Agent<T>::getSpeedFactorApproachFriends(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::getSpeedFactorApproachFriends: \
       getting scale factor for approaching friends" << std::endl;
   }
 #endif
 
-  return sim_params.agent_class_params[state.class_id[id]].
+  return data.sim_params.agent_class_params[state.class_id[id]].
                                   getMovespeedApproachFriends();
 }
 
@@ -974,13 +775,13 @@ template<typename T>
 T Agent<T>::getSpeedFactorApproachFood(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "agent::getSpeedFactorApproachFood: \
       getting scale factor for approaching food" << std::endl;
   }
 #endif
 
-  return sim_params.agent_class_params[state.class_id[id]].
+  return data.sim_params.agent_class_params[state.class_id[id]].
                                   getMovespeedApproachFood();
 }
 
@@ -988,13 +789,13 @@ template<typename T>
 T Agent<T>::getSpeedFactorAvoidEnemies(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "agent::getSpeedFactorAvoidEnemies: \
       getting scale factor for avoiding enemies" << std::endl;
   }
 #endif
 
-  return sim_params.agent_class_params[state.class_id[id]].
+  return data.sim_params.agent_class_params[state.class_id[id]].
                                   getMovespeedAvoidEnemies();
 }
 
@@ -1002,13 +803,13 @@ template<typename T>
 T Agent<T>::getSpeedFactorSearch(const State<T> &state)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::getSpeedFactorSearch: \
       getting scale factor for searching" << std::endl;
   }
 #endif
 
-  return sim_params.agent_class_params[state.class_id[id]].
+  return data.sim_params.agent_class_params[state.class_id[id]].
                                   getMovespeedSearch();
 }
 
@@ -1020,10 +821,10 @@ int Agent<T>::getNumContact(const State<T> &state,
   // Sum up the number of contacts of all given classes
   for (int i=0; i<class_ids.size(); i++){
     int index = class_ids[i];
-    sum += agent_classes.at(index).getNumContact(state, id);
+    sum += data.agent_classes.at(index).getNumContact(state, id);
   }
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::getNumContact: \
       found " << sum << " contacts" << std::endl;
   }
@@ -1039,10 +840,10 @@ int Agent<T>::getNumReachable(const State<T> &state,
   // Sum up the number of reachable agents of all given classes
   for (int i=0; i<class_ids.size(); i++){
     int index = class_ids[i];
-    sum += agent_classes.at(index).getNumReachable(state, id);
+    sum += data.agent_classes.at(index).getNumReachable(state, id);
   }
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::getNumReachable: \
       found " << sum << " reachable agents" << std::endl;
   }
@@ -1058,10 +859,10 @@ int Agent<T>::getNumAudible(const State<T> &state,
   // Sum up the number of audible agents of all given classes
   for (int i=0; i<class_ids.size(); i++){
     int index = class_ids[i];
-    sum += agent_classes.at(index).getNumAudible(state, id);
+    sum += data.agent_classes.at(index).getNumAudible(state, id);
   }
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::getNumAudible: \
       found " << sum << " audible agents" << std::endl;
   }
@@ -1073,7 +874,7 @@ template <typename T>
 bool Agent<T>::foodContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::foodContact: \
       Checking if the agent is in contact with food" << std::endl;
   }
@@ -1087,7 +888,7 @@ template <typename T>
 bool Agent<T>::friendContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::friendContact: \
       Checking if the agent is in contact with friends" << std::endl;
   }
@@ -1100,7 +901,7 @@ template <typename T>
 bool Agent<T>::enemyContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::enemyContact: \
       Checking if the agent is in contact with enemies" << std::endl;
   }
@@ -1113,7 +914,7 @@ template <typename T>
 bool Agent<T>::foodReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::foodReachable: \
       Checking if the agent is in reach of food" << std::endl;
   }
@@ -1126,7 +927,7 @@ template <typename T>
 bool Agent<T>::friendReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::friendReachable: \
       Checking if the agent is in reach of friends" << std::endl;
   }
@@ -1140,7 +941,7 @@ template <typename T>
 bool Agent<T>::enemyReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::enemyReachable: \
       Checking if the agent is in reach of enemies" << std::endl;
   }
@@ -1154,7 +955,7 @@ template <typename T>
 bool Agent<T>::foodAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::foodAudible: \
       Checking if the agent can hear food" << std::endl;
   }
@@ -1167,7 +968,7 @@ template <typename T>
 bool Agent<T>::friendAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::friendAudible: \
       Checking if the agent can hear friends" << std::endl;
   }
@@ -1181,7 +982,7 @@ template <typename T>
 bool Agent<T>::enemyAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::enemyAudible: \
       Checking if the agent can hear enemies" << std::endl;
   }
@@ -1195,7 +996,7 @@ template <typename T>
 bool Agent<T>::attacked(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::attacked: \
       Checking if the agent is attacked" << std::endl;
   }
@@ -1209,162 +1010,126 @@ template <typename T>
 int Agent<T>::numFoodContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFoodContact: \
       Counting the number of food sources in contact" << std::endl;
   }
 #endif
 
-  // Get vector of food sources
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
-
-  // Count the number of food sources in contact
-  return getNumContact(state, food_source_ids);
+  // Count the number of food sources in contact, from the awareness
+  return getAwarenessCount(state, RELATION_FOOD, AWARENESS_LEVEL_CONTACT);
 }
 
 template <typename T>
 int Agent<T>::numFriendContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFriendContact: \
       Counting the number of friends in contact" << std::endl;
   }
 #endif
 
-  // Get vector of friends
-  std::vector<int> friend_ids 
-    = sim_params.getFriendIds(state.class_id[id]);
-
-  // Count the number of friends in contact
-  return getNumContact(state, friend_ids);
+  // Count the number of friends in contact, from the awareness
+  return getAwarenessCount(state, RELATION_FRIEND, AWARENESS_LEVEL_CONTACT);
 }
 
 template <typename T>
 int Agent<T>::numEnemyContact(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numEnemyContact: \
       Counting the number of enemies in contact" << std::endl;
   }
 #endif
 
-  // Get vector of enemies
-  std::vector<int> enemy_ids 
-    = sim_params.getEnemyIds(state.class_id[id]);
-
-  // Count the number of enemies in contact
-  return getNumContact(state, enemy_ids);
+  // Count the number of enemies in contact, from the awareness
+  return getAwarenessCount(state, RELATION_ENEMY, AWARENESS_LEVEL_CONTACT);
 }
 
 template <typename T>
 int Agent<T>::numFoodReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFoodReachable: \
       Counting the number of food sources in reach" << std::endl;
   }
 #endif
 
-  // Get vector of food sources
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
-
-  // Count the number of food sources in reach
-  return getNumReachable(state, food_source_ids);
+  // Count the number of food sources in reach, from the awareness
+  return getAwarenessCount(state, RELATION_FOOD, AWARENESS_LEVEL_REACHABLE);
 }
 
 template <typename T>
 int Agent<T>::numFriendReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFriendReachable: \
       Counting the number of friends in reach" << std::endl;
   }
 #endif
 
-  // Get vector of friends
-  std::vector<int> friend_ids 
-    = sim_params.getFriendIds(state.class_id[id]);
-
-  // Count the number of friends in reach
-  return getNumReachable(state, friend_ids);
+  // Count the number of friends in reach, from the awareness
+  return getAwarenessCount(state, RELATION_FRIEND, AWARENESS_LEVEL_REACHABLE);
 }
 
 template <typename T>
 int Agent<T>::numEnemyReachable(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numEnemyReachable: \
       Counting the number of enemies in reach" << std::endl;
   }
 #endif
 
-  // Get vector of enemies
-  std::vector<int> enemy_ids 
-    = sim_params.getEnemyIds(state.class_id[id]);
-
-  // Count the number of enemies in reach
-  return getNumReachable(state, enemy_ids);
+  // Count the number of enemies in reach, from the awareness
+  return getAwarenessCount(state, RELATION_ENEMY, AWARENESS_LEVEL_REACHABLE);
 }
 
 template <typename T>
 int Agent<T>::numFoodAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFoodAudible: \
       Counting the number of food sources audible" << std::endl;
   }
 #endif
 
-  // Get vector of food sources
-  std::vector<int> food_source_ids 
-    = sim_params.getFoodSourceIds(state.class_id[id]);
-
-  // Count the number of food sources audible
-  return getNumAudible(state, food_source_ids);
+  // Count the number of food sources audible, from the awareness
+  return getAwarenessCount(state, RELATION_FOOD, AWARENESS_LEVEL_AUDIBLE);
 }
 
 template <typename T>
 int Agent<T>::numFriendAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numFriendAudible: \
       Counting the number of friends audible" << std::endl;
   }
 #endif
 
-  // Get vector of friends
-  std::vector<int> friend_ids 
-    = sim_params.getFriendIds(state.class_id[id]);
-
-  // Count the number of friends audible
-  return getNumAudible(state, friend_ids);
+  // Count the number of friends audible, from the awareness
+  return getAwarenessCount(state, RELATION_FRIEND, AWARENESS_LEVEL_AUDIBLE);
 }
 
 template <typename T>
 int Agent<T>::numEnemyAudible(const State<T> &state) const
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::numEnemyAudible: \
       Counting the number of enemies audible" << std::endl;
   }
 #endif
 
-  // Get vector of enemies
-  std::vector<int> enemy_ids 
-    = sim_params.getEnemyIds(state.class_id[id]);
-
-  // Count the number of enemies audible
-  return getNumAudible(state, enemy_ids);
+  // Count the number of enemies audible, from the awareness
+  return getAwarenessCount(state, RELATION_ENEMY, AWARENESS_LEVEL_AUDIBLE);
 }
 
 template <typename T>
@@ -1372,13 +1137,11 @@ int Agent<T>::findClosestContact(const State<T> &state, int &class_id)
 {
 
   // Find the closest agent of the given class in contact
-  if (agent_classes.at(class_id).getNumContact(state, id) > 0){
-    int target_id = agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.contact[id * sim_params.num_agents_total]
-        );
+  if (data.agent_classes.at(class_id).getNumContact(state, id) > 0){
+    int target_id = data.agent_classes[class_id].findClosest(
+        state, id, AWARENESS_LEVEL_CONTACT, NULL);
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::findClosestContact: \
       Finding the closest target of class " << class_id << 
       " in contact with agent "<< id << std::endl;
@@ -1391,7 +1154,7 @@ int Agent<T>::findClosestContact(const State<T> &state, int &class_id)
 
   // Return -1 if no agent is in contact
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::findClosestContact: Agent: " << id <<
       " No target found" << std::endl;
   }
@@ -1403,7 +1166,7 @@ template <typename T>
 int Agent<T>::findClosestReachable(const State<T> &state, int &class_id)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::findClosestReachable: \
       Finding the closest target of class " << class_id << 
       " reachable by agent "<< id << std::endl;
@@ -1411,16 +1174,14 @@ int Agent<T>::findClosestReachable(const State<T> &state, int &class_id)
 #endif
 
   // Find the closest agent of the given class in reach
-  if (agent_classes.at(class_id).getNumReachable(state, id) > 0){
-    return agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.reachability[id * sim_params.num_agents_total]
-        );
+  if (data.agent_classes.at(class_id).getNumReachable(state, id) > 0){
+    return data.agent_classes[class_id].findClosest(
+        state, id, AWARENESS_LEVEL_REACHABLE, NULL);
   }
 
   // Return -1 if no agent was found
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::findClosestReachable: Agent: " << id <<
       " No target found" << std::endl;
   }
@@ -1432,7 +1193,7 @@ template <typename T>
 int Agent<T>::findClosestAudible(const State<T> &state, int &class_id)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::findClosestAudible: \
       Finding the closest target of class " << class_id << 
       " audible by agent "<< id << std::endl;
@@ -1440,16 +1201,14 @@ int Agent<T>::findClosestAudible(const State<T> &state, int &class_id)
 #endif
 
   // Find the closest agent of the given class in audible range
-  if (agent_classes.at(class_id).getNumAudible(state, id) > 0){
-    return agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.audibility[id * sim_params.num_agents_total]
-        );
+  if (data.agent_classes.at(class_id).getNumAudible(state, id) > 0){
+    return data.agent_classes[class_id].findClosest(
+        state, id, AWARENESS_LEVEL_AUDIBLE, NULL);
   }
 
   // Return -1 if no agent was found
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::findClosestAudible: Agent: " << id <<
       " No target found" << std::endl;
   }
@@ -1461,7 +1220,7 @@ template <typename T>
 int Agent<T>::findClosestAware(const State<T> &state, int class_id)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::findClosestAware: \
       Finding the closest target of class " << class_id << 
       " aware by agent "<< id << std::endl;
@@ -1483,7 +1242,7 @@ int Agent<T>::findClosestAware(const State<T> &state, int class_id)
 
   // Return -1 if no agent was found
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::findClosestAware: Agent: " << id <<
       " No target found" << std::endl;
   }
@@ -1496,162 +1255,38 @@ int Agent<T>::findClosest(const State<T> &state,
     const std::vector<int> &target_classes)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::findClosest: \
       Finding the closest target" << std::endl;
   }
 #endif
 
-  std::vector<int> target_ids;
-  return findClosest(state, target_classes, target_ids);
+  return findClosest(state, target_classes, NULL);
 
 }
 
 template <typename T>
-int Agent<T>::findClosestContact(const State<T> &state, int &class_id,
-    const std::vector<int> &audible_classes)
-{
-
-  // Find the closest agent of the given class in contact
-  if (agent_classes.at(class_id).getNumContact(state, id) > 0){
-    int target_id = agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.contact[id * sim_params.num_agents_total],
-        &state.audibility_agent_to_class[0], audible_classes
-        );
-#ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::findClosestContact: \
-      (2masks) Finding the closest target of class " << class_id << 
-      " in contact with agent "<< id << std::endl;
-    std::cout << "Agent::findClosestContact: \
-      Target id: " << target_id << std::endl;
-  }
-#endif
-    return target_id;
-  }
-
-  // Return -1 if no agent is in contact
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::findClosestContact: Agent: " << id <<
-      " No target found" << std::endl;
-  }
-#endif
-  return (-1);
-}
-
-template <typename T>
-int Agent<T>::findClosestReachable(const State<T> &state, int &class_id, 
-    const std::vector<int> &audible_classes)
-{
-#ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::findClosestReachable: \
-      (audibility-metamask) Finding the closest target of class " 
-      << class_id << " reachable by agent "<< id << std::endl;
-  }
-#endif
-
-  // Find the closest agent of the given class in reach
-  if (agent_classes.at(class_id).getNumReachable(state, id) > 0){
-    return agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.reachability[id * sim_params.num_agents_total],
-        &state.audibility_agent_to_class[0], audible_classes);
-  }
-
-  // Return -1 if no agent was found
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::findClosestReachable: Agent: " << id <<
-      " No target found" << std::endl;
-  }
-#endif
-  return (-1);
-}
-
-template <typename T>
-int Agent<T>::findClosestAudible(const State<T> &state, int &class_id,
-    const std::vector<int> &audible_classes)
-{
-#ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::findClosestAudible: \
-      (2masks) Finding the closest target of class " << class_id << 
-      " audible by agent "<< id << std::endl;
-  }
-#endif
-
-  // Find the closest agent of the given class in audible range
-  if (agent_classes.at(class_id).getNumAudible(state, id) > 0){
-    return agent_classes[class_id].findMin(
-        &state.distances_agent_to_agent[id * sim_params.num_agents_total], 
-        &state.audibility[id * sim_params.num_agents_total],
-        &state.audibility_agent_to_class[0], audible_classes
-        );
-  }
-
-  // Return -1 if no agent was found
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::findClosestAudible: Agent: " << id <<
-      " No target found" << std::endl;
-  }
-#endif
-  return (-1);
-}
-
-template <typename T>
-int Agent<T>::findClosestAware(const State<T> &state, int class_id,
-    const std::vector<int> &audible_classes)
+int Agent<T>::findClosest(const State<T> &state, 
+    const std::vector<int> &target_classes, 
+    const uint64_t *hears)
 {
-#ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::findClosestAware: \
-      (audibility-metamask) Finding the closest target of class " 
-      << class_id << 
-      " aware by agent "<< id << std::endl;
-  }
-#endif
-  int target_id = -1;
-
-  // Try to find the closest agent in reach
-  target_id = findClosestReachable(state, class_id, audible_classes);
-  if (target_id > -1){
-    return target_id;
-  }
-
-  // Try to find the closest agent in audible range
-  target_id = findClosestAudible(state, class_id, audible_classes);
-  if (target_id > -1){
-    return target_id;
-  }
-
-  // Return -1 if no agent was found
-#ifdef DEBUG
-  if (verbosity > 3){
-    std::cout << "Agent::findClosestAware (2masks): Agent: " << id <<
-      " No target found" << std::endl;
-  }
-#endif
-  return (-1);
+  return findClosest(state, target_classes, AWARENESS_AWARE, hears);
 }
 
 template <typename T>
 int Agent<T>::findClosest(const State<T> &state, 
-    const std::vector<int> &target_classes, 
-    const std::vector<int> &audible_classes,
-    bool two_masks)
+    const std::vector<int> &target_classes, int levels,
+    const uint64_t *hears)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::findClosest: \
-      (2masks) Finding the closest target of the given classes, \
-      that hears at least one of the given audible classes" << std::endl;
+      Finding the closest target of the given classes and awareness \
+      levels " << levels << ", whose bit in hears is set, if given" 
+      << std::endl;
   }
 
-  if (verbosity > 4){
+  if (data.verbosity > 4){
     // Print target classes
     std::cout << "Agent::findClosest: \
       Target classes: ";
@@ -1659,58 +1294,63 @@ int Agent<T>::findClosest(const State<T> &state,
       std::cout << target_classes[i] << " ";
     }
     std::cout << std::endl;
-    // Print audible classes
-    std::cout << "Agent::findClosest: \
-      Audible classes: ";
-    for (int i = 0; i < audible_classes.size(); i++){
-      std::cout << audible_classes[i] << " ";
-    }
-    std::cout << std::endl;
   }
 #endif
 
-  // Set up a minimizer
-  int target_id_class[target_classes.size()];
-  for (int i = 0; i < target_classes.size(); i++){
-    target_id_class[i] = -1;
-  }
+  typedef typename State<T>::distance_type distance_type;
+  int pitch = state.getPitch();
+  const distance_type *distances = 
+    &state.distances_agent_to_agent[id * pitch];
 
-  // Find the closest target of each given class
-  for (int i = 0; i < target_classes.size(); i++){
-    if (!two_masks){
-      target_id_class[i] = findClosestAware(state, target_classes[i]);
-    } else {
-      target_id_class[i] = 
-        findClosestAware(state, target_classes[i], audible_classes);
-    }
-  }
+  // Counts of the awareness levels, in the order they are tried
+  const int *counts[NUM_AWARENESS_LEVELS] = {
+    state.contact_agent_to_class,
+    state.reachability_agent_to_class,
+    state.audibility_agent_to_class
+  };
 
-  // Find the overall closest target
   int target_id = -1;
   for (int i = 0; i < target_classes.size(); i++){
-
-    // Test if an agent of the target class was found
-    if (target_id_class[i] < 0){
+    int class_id = target_classes[i];
+
+    // Levels with agents of the class, skip the class if there are none
+    int class_levels = 0;
+    for (int l = 0; l < NUM_AWARENESS_LEVELS; l++){
+      if ((levels & (1 << l)) 
+          && counts[l][class_id * pitch + id] > 0){
+        class_levels |= 1 << l;
+      }
+    }
+    if (class_levels == 0){
       continue;
     }
 
-    // Set the target id if not set
-    if (target_id < 0){
-      target_id = target_id_class[i];
+    // The first level with a target decides the target of the class,
+    // the counts leave only one level to search unless hears masks it out
+    int class_target = -1;
+    for (int l = 0; l < NUM_AWARENESS_LEVELS && class_target < 0; l++){
+      if (class_levels & (1 << l)){
+        class_target = 
+          data.agent_classes[class_id].findClosest(state, id, l, hears);
+      }
+    }
+    if (class_target < 0){
+      continue;
     }
 
-    // Compare the distance of the target and the current food source
-    int index_current = 
-      id * sim_params.num_agents_total + target_id_class[i];
-    int index_target = 
-      id * sim_params.num_agents_total + target_id;
-    if (state.distances_agent_to_agent[index_current]
-        <
-        state.distances_agent_to_agent[index_target]){
-      target_id = target_id_class[i];
+    // Keep the overall closest target, ties go to the first class
+    if (target_id < 0 || distances[class_target] < distances[target_id]){
+      target_id = class_target;
     }
   }
 
+#ifdef DEBUG
+  if (data.verbosity > 2){
+    std::cout << "Agent::findClosest: Agent: " << id << 
+      " Target id: " << target_id << std::endl;
+  }
+#endif
+
   // Return the target id
   return target_id;
 }
@@ -1720,80 +1360,72 @@ Point3D<T> Agent<T>::approachClosest(const State<T> &state,
     const std::vector<int> &target_classes, T scale)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::approachClosest: \
       Approaching the closest target of the given classes" << std::endl;
   }
 #endif
 
-  // Find the closest target
-  int target_id = findClosest(state, target_classes);
+  // Find the closest target and approach it
+  return approachTarget(state, findClosest(state, target_classes), scale);
+}
 
-  // Test if a target was found
-  if (target_id < 0){
+template <typename T>
+Point3D<T> Agent<T>::approachClosest(const State<T> &state, 
+    const std::vector<int> &target_classes, 
+    const uint64_t *hears, T scale)
+{
 #ifdef DEBUG
-  if (verbosity > 2){
+  if (data.verbosity > 1){
     std::cout << "Agent::approachClosest: \
-      No target found" << std::endl;
+      (2masks)Approaching the closest target of the given classes" 
+      << std::endl;
   }
 #endif
-    return (Point3D<T>(0.0, 0.0, 0.0));
-  }
-
-  // Calculate the direction to the target
-  Point3D<T> direction = 
-    state.positions[id].normalizedDirection(state.positions[target_id]);
-
-  // Get the distance to the target
-  T distance = 
-    state.positions[id].distance(state.positions[target_id]);
-
-  // Make sure the agent does not overshoot the target
-  T max_move_distance = state.movespeed[id] * scale;
-  if (distance < max_move_distance){
-    direction *= distance;
-  } else {
-    direction *= max_move_distance;
-  }
 
-  // Simulation parameters
-  return (direction);
+  // Find the closest target and approach it
+  return approachTarget(state, 
+      findClosest(state, target_classes, hears), scale);
 }
 
 template <typename T>
-Point3D<T> Agent<T>::approachClosest(const State<T> &state, 
-    const std::vector<int> &target_classes, 
-    const std::vector<int> &audible_classes, T scale)
+Point3D<T> Agent<T>::avoidClosest(const State<T> &state, 
+    const std::vector<int> &target_classes, T scale)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::approachClosest: \
-      (2masks)Approaching the closest target of the given classes" 
-      << std::endl;
+  if (data.verbosity > 1){
+    std::cout << "Agent::avoidClosest: \
+      Avoiding the closest target of the given classes" << std::endl;
   }
 #endif
 
-  // Find the closest target
-  int target_id = findClosest(state, target_classes, audible_classes, true);
+  // Find the closest target and avoid it
+  return avoidTarget(state, findClosest(state, target_classes), scale);
+}
 
+template <typename T>
+Point3D<T> Agent<T>::approachTarget(const State<T> &state, int target_id,
+    T scale)
+{
   // Test if a target was found
   if (target_id < 0){
 #ifdef DEBUG
-  if (verbosity > 2){
-    std::cout << "Agent::approachClosest: \
+  if (data.verbosity > 2){
+    std::cout << "Agent::approachTarget: \
       No target found" << std::endl;
   }
 #endif
     return (Point3D<T>(0.0, 0.0, 0.0));
   }
 
-  // Calculate the direction to the target
-  Point3D<T> direction = 
-    state.positions[id].normalizedDirection(state.positions[target_id]);
+  // Calculate the direction to the target, its closest image in a 
+  // periodic world
+  Point3D<T> target = state.positions[id].image(
+      state.positions[target_id], data.sim_params.getPeriodicBox());
+  Point3D<T> direction = state.positions[id].normalizedDirection(target);
 
   // Get the distance to the target
-  T distance = 
-    state.positions[id].distance(state.positions[target_id]);
+  T distance = state.positions[id].distance(target);
 
   // Make sure the agent does not overshoot the target
   T max_move_distance = state.movespeed[id] * scale;
@@ -1808,22 +1440,12 @@ Point3D<T> Agent<T>::approachClosest(const State<T> &state,
 }
 
 template <typename T>
-Point3D<T> Agent<T>::avoidClosest(const State<T> &state, 
-    const std::vector<int> &target_classes, T scale)
+Point3D<T> Agent<T>::avoidTarget(const State<T> &state, int target_id,
+    T scale)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
-    std::cout << "Agent::avoidClosest: \
-      Avoiding the closest target of the given classes" << std::endl;
-  }
-#endif
-
-  // Find the closest target
-  int target_id = findClosest(state, target_classes);
-
-#ifdef DEBUG
-  if (verbosity > 2){
-    std::cout << "Agent::avoidClosest: \
+  if (data.verbosity > 2){
+    std::cout << "Agent::avoidTarget: \
       Agent: " << id << " Target id: " << target_id << std::endl;
   }
 #endif
@@ -1831,15 +1453,17 @@ Point3D<T> Agent<T>::avoidClosest(const State<T> &state,
   // Test if a target was found
   if (target_id < 0){
 #ifdef DEBUG
-    std::cout << "Agent::avoidClosest: \
+    std::cout << "Agent::avoidTarget: \
       No target found" << std::endl;
 #endif
     return (Point3D<T>(0.0, 0.0, 0.0));
   }
 
-  // Calculate the direction to the target
-  Point3D<T> direction = 
-    state.positions[id].normalizedDirection(state.positions[target_id]);
+  // Calculate the direction to the target, its closest image in a 
+  // periodic world
+  Point3D<T> direction = state.positions[id].normalizedDirection(
+      state.positions[id].image(state.positions[target_id], 
+        data.sim_params.getPeriodicBox()));
 
   // Invert the direction
   direction *= -1.0;
@@ -1850,23 +1474,91 @@ Point3D<T> Agent<T>::avoidClosest(const State<T> &state,
   return (direction);
 }
 
+template <typename T>
+void Agent<T>::fillAwareness(const State<T> &state) const
+{
+  if (data.awareness_valid[id]){
+    return;
+  }
+
+#ifdef DEBUG
+  if (data.verbosity > 3){
+    std::cout << "Agent::fillAwareness: \
+      Filling the awareness of agent " << id << std::endl;
+  }
+#endif
+
+  // Sum up the agent to class counts of the classes of each relation
+  int class_id = state.class_id[id];
+  int pitch = state.getPitch();
+  const int *counts[NUM_AWARENESS_LEVELS] = {
+    state.contact_agent_to_class,
+    state.reachability_agent_to_class,
+    state.audibility_agent_to_class
+  };
+  for (int r = 0; r < NUM_RELATIONS; r++){
+    const std::vector<int> &classes = 
+      data.sim_params.getRelationIds(class_id, r);
+    for (int l = 0; l < NUM_AWARENESS_LEVELS; l++){
+      int sum = 0;
+      for (int c : classes){
+        sum += counts[l][c * pitch + id];
+      }
+      data.awareness_counts[data.countIndex(id, r, l)] = sum;
+    }
+    int *closest = &data.awareness_closest[data.closestIndex(id, r, 0)];
+    std::fill(closest, closest + AWARENESS_ALL + 1, CLOSEST_UNKNOWN);
+  }
+
+  data.awareness_valid[id] = 1;
+}
+
+template <typename T>
+int Agent<T>::getAwarenessCount(const State<T> &state, int relation,
+    int level) const
+{
+  fillAwareness(state);
+  return data.awareness_counts[data.countIndex(id, relation, level)];
+}
+
+template <typename T>
+int Agent<T>::findClosestRelation(const State<T> &state, int relation,
+    int levels)
+{
+  fillAwareness(state);
+  int &closest = data.awareness_closest[data.closestIndex(id, relation, 
+      levels)];
+  if (closest == CLOSEST_UNKNOWN){
+    closest = findClosest(state, 
+        data.sim_params.getRelationIds(state.class_id[id], relation), 
+        levels, NULL);
+  }
+  return closest;
+}
+
 template <typename T>
 void Agent<T>::boundaryControl(Point3D<T> &pos)
 {
 #ifdef DEBUG
-  if (verbosity > 1){
+  if (data.verbosity > 1){
     std::cout << "Agent::boundaryControl: \
       Keeping agent within boundaries" << std::endl;
   }
 #endif
 
   // Test if the agent is within the boundaries
-  if (sim_params.isInsideWorld(pos)){
+  if (data.sim_params.isInsideWorld(pos)){
+    return;
+  }
+
+  // Agents leaving a periodic world enter it on the other side
+  if (data.sim_params.getPeriodic()){
+    data.sim_params.wrapIntoWorld(pos);
     return;
   }
 
   // Restrict the agent to the boundaries
-  const T* worldsize = sim_params.getWorldsize();
+  const T* worldsize = data.sim_params.getWorldsize();
   for (int i = 0; i < 3; i++){
     if (pos[i] > worldsize[i]){
       pos[i] = worldsize[i] - (pos[i] - worldsize[i]);
@@ -1878,30 +1570,16 @@ void Agent<T>::boundaryControl(Point3D<T> &pos)
 }
 
 template <typename T>
-void Agent<T>::initSearch(
-    int class_id,
-    SimulationParameters<T> &sim_params,
-    std::mt19937 &gen)
+void Agent<T>::initSearch(int class_id)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::initSearch: \
       Initializing the search object" << std::endl;
   }
 #endif
-  T mu_levy = sim_params.agent_class_params[class_id].getMuLevy();
-  T c_levy = sim_params.agent_class_params[class_id].getCLevy();
-  T brownian_search_duration = 
-    sim_params.agent_class_params[class_id].getBrownianSearchDuration();
-  T worldsize[3]; 
-  sim_params.getWorldsize(worldsize);
-
-  // Initialize the search object
-  search_memory = Search<T>(
-      id, gen, 
-      dist_uni, dist_x, dist_y, dist_z,
-      mu_levy, c_levy, brownian_search_duration,
-      worldsize);
+  // Start over the search in the search memory
+  data.search_state.reset(id, class_id);
 }
 
 template <typename T>
@@ -1909,7 +1587,7 @@ void Agent<T>::giveEnergy(const State<T> &state, State<T> &new_state, int &other
     double amount)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::giveEnergy: \
       Agent " << id << " giving " << amount << " energy to agent "
       << other_id << std::endl;
@@ -1934,9 +1612,9 @@ void Agent<T>::giveEnergy(const State<T> &state, State<T> &new_state, int &other
 #ifdef DEBUG
   // Keep track of the energy exchanged
 #pragma omp atomic
-  agent_metrics.energy_turnover_soll[id] += amount;
+  data.agent_metrics.energy_turnover_soll[id] += amount;
 #pragma omp atomic
-  agent_metrics.energy_turnover_haben[other_id] += amount;
+  data.agent_metrics.energy_turnover_haben[other_id] += amount;
 #endif
 
 }
@@ -1946,7 +1624,7 @@ void Agent<T>::respawn(const State<T> &state, State<T> &new_state,
     const int &class_id)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::respawn: \
       Respawning the agent" << std::endl;
   }
@@ -1957,7 +1635,7 @@ void Agent<T>::respawn(const State<T> &state, State<T> &new_state,
 
   // Get the class parameters of the new agent
   AgentClassParameters<T> &p = 
-    sim_params.agent_class_params[class_id];
+    data.sim_params.agent_class_params[class_id];
 
 
   /* Init the new agent */
@@ -1965,30 +1643,46 @@ void Agent<T>::respawn(const State<T> &state, State<T> &new_state,
   // Set the new position
   // Set to random, else predators will wait at the roost if they find it
   new_state.positions[id] = Point3D<T>(
-      dist_x(gen), dist_y(gen), dist_z(gen));
+      data.dist_x(data.gen), data.dist_y(data.gen), data.dist_z(data.gen));
   /*
   if (p.random_start_positions){
     new_state.positions[id] = Point3D<T>(
-        dist_x(gen), dist_y(gen), dist_z(gen));
+        data.dist_x(data.gen), data.dist_y(data.gen), data.dist_z(data.gen));
   } else {
     new_state.positions[id] = p.start_position;
   }
   */
   
   // Set the new energy
-  new_state.energy[id] = p.dist_energy(gen);
+  new_state.energy[id] = p.dist_energy(data.gen);
   if (new_state.energy[id] < 0.0){
     new_state.energy[id] = 0.0; // Totgeburt
   }
 
 #ifdef DEBUG
   // Keep track of the energy added to the system
-  agent_metrics.energy_added_to_system[id] += new_state.energy[id];
+  data.agent_metrics.energy_added_to_system[id] += new_state.energy[id];
 #endif
 
   // Clear the energy exchange register
-  energy_exchange_register.clear();
+  data.clearExchanges(id);
+
+  // Set the properties of the class
+  initClassProperties(new_state, p);
 
+  // Refresh search memory
+  initSearch(state.class_id[id]);
+
+  // Set the transition state to alive
+  data.transition_state[id] = Status::ALIVE;
+  data.born[id] = 1;
+
+}
+
+template <typename T>
+void Agent<T>::initClassProperties(State<T> &new_state, 
+    const AgentClassParameters<T> &p)
+{
   // Set the new movespeed
   new_state.movespeed[id] = p.movespeed;
 
@@ -2013,20 +1707,58 @@ void Agent<T>::respawn(const State<T> &state, State<T> &new_state,
 
   // Set the new energy uptake rate
   new_state.energy_uptake_rate[id] = p.energy_uptake_rate;
+}
 
-  // Refresh search memory
-  initSearch(state.class_id[id], sim_params, gen);
+template <typename T>
+void Agent<T>::vacate(State<T> &new_state)
+{
+#ifdef DEBUG
+  if (data.verbosity > 3){
+    std::cout << "Agent::vacate: \
+      Freeing the slot of agent " << id << std::endl;
+  }
+#endif
 
-  // Set the transition state to alive
-  transition_state = Status::ALIVE;
+  new_state.status[id] = (int)Status::VACANT;
+  new_state.energy[id] = 0.0;
+  data.clearExchanges(id);
+  data.transition_state[id] = Status::VACANT;
+}
 
+template <typename T>
+void Agent<T>::reproduce(State<T> &new_state, int child_id)
+{
+#ifdef DEBUG
+  if (data.verbosity > 3){
+    std::cout << "Agent::reproduce: \
+      Agent " << id << " splits into slot " << child_id << std::endl;
+  }
+#endif
+
+  const int class_id = new_state.class_id[id];
+  AgentClassParameters<T> &p = data.sim_params.agent_class_params[class_id];
+  Agent<T> &child = data.agents[child_id];
+
+  // The child starts at the position of the parent with half of its 
+  // energy, the energy of the system is kept
+  new_state.class_id[child_id] = class_id;
+  new_state.positions[child_id] = new_state.positions[id];
+  new_state.energy[id] *= (T)0.5;
+  new_state.energy[child_id] = new_state.energy[id];
+  child.initClassProperties(new_state, p);
+
+  // Start the child with an empty register and a new search
+  data.clearExchanges(child_id);
+  child.initSearch(class_id);
+  data.transition_state[child_id] = Status::ALIVE;
+  data.born[child_id] = 1;
 }
 
 template <typename T>
 void Agent<T>::setTransitionState(Status status)
 {
 #ifdef DEBUG
-  if (verbosity > 3){
+  if (data.verbosity > 3){
     std::cout << "Agent::setStatus: \
       Setting the transition state to ";
     switch (status){
@@ -2039,13 +1771,16 @@ void Agent<T>::setTransitionState(Status status)
       case Status::ATTACKED:
         std::cout << "ATTACKED" << std::endl;
         break;
+      case Status::VACANT:
+        std::cout << "VACANT" << std::endl;
+        break;
       default:
         std::cout << "UNKNOWN" << std::endl;
         break;
     }
   }
 #endif
-  transition_state = status;
+  data.transition_state[id] = status;
 }
 
 
@@ -8,7 +8,8 @@
 #include "AgentClassParameters.h"
 #include "State.h"
 #include "AgentClass.h"
-#include "Search.h"
+#include "SearchState.h"
+#include "AgentData.h"
 #include "helpers.h"
 #include "AgentMetrics.h"
 
@@ -18,30 +19,24 @@
 #define DEATH_THRESHOLD 0.1 // Do not put this to zero, 
                             // otherwise problems will occur
 
-enum class Status{
-  DEAD,
-  ALIVE,
-  ATTACKED
-};
+// Template argument of the strategy kernels, select the strategy 
+// from the state at runtime
+#define DYNAMIC_STRATEGY -1
+
+// Building blocks of the move strategies, see MoveStrategies.h
+struct MoveBlocks;
 
 template <typename T>
 class Agent
 {
+  // The move strategies are composed of blocks using the private
+  // predicates and moves of the agent
+  friend struct MoveBlocks;
+
  public:
 
   // Constructor
-  Agent(int id, 
-      int verbosity,
-      SimulationParameters<T> &sim_params, 
-      std::vector<Agent<T>> &agents,
-      std::vector<AgentClass<T>> &agent_classes,
-      AgentMetrics<T> &agent_metrics,
-      std::mt19937 &gen,
-      std::uniform_real_distribution<T> &dist_uni,
-      std::uniform_real_distribution<T> &dist_x,
-      std::uniform_real_distribution<T> &dist_y,
-      std::uniform_real_distribution<T> &dist_z
-      );
+  Agent(int id, AgentData<T> &data);
 
   // Destructor
   ~Agent();
@@ -63,6 +58,15 @@ class Agent
   // Update position
   void updatePosition(const State<T> &state, State<T> &new_state);
 
+  // Update the positions of a batch of agents sharing one move strategy,
+  // the strategy is dispatched once per batch instead of once per agent
+  static void updatePositions(std::vector<Agent<T>> &agents, 
+      const State<T> &state, State<T> &new_state, 
+      int strategy, const int *ids, int num_ids);
+
+  // Stay at the current position
+  void stay(const State<T> &state, State<T> &new_state);
+
   // Update movement speed
   void updateMovespeed(const State<T> &state, State<T> &new_state);
 
@@ -107,66 +111,51 @@ class Agent
   void energyExchangePartTwoDistribute(const State<T> &state, 
       State<T> &new_state);
 
+  // Split into two, the child takes the free slot child_id of the class
+  // and half of the energy, call after updateStatus
+  void reproduce(State<T> &new_state, int child_id);
+
   
  private:
 
-  // Random number generator
-  std::mt19937 &gen;
-
-  // Distribution for random numbers
-  std::uniform_real_distribution<T> &dist_uni;
-  std::uniform_real_distribution<T> &dist_x;
-  std::uniform_real_distribution<T> &dist_y;
-  std::uniform_real_distribution<T> &dist_z;
-
   // Id of the agent
   int id;
 
-  // Transition state, not necessaryly equal to the status, only
-  // relevant within one transition, currently 
-  // for example used for respawn,
-  // thus death and rebirth are possible within one iteration; 
-  // 
-  // The status in the state object should only be changed by the
-  // updateStatus function, other functions should use the transition_state,
-  // updateStatus should handle the synchronization with the state object
-  Status transition_state;
-
-  // Reference to vector of other agents
-  std::vector<Agent<T>> &agents;
+  // Shared data and per agent fields of all agents, the agent only 
+  // holds its id, the mutable fields are in the arrays of this table
+  AgentData<T> &data;
 
-  // Reference to the agent metrics
-  AgentMetrics<T> &agent_metrics;
+  // Fill the awareness of the agent if invalid
+  void fillAwareness(const State<T> &state) const;
 
-  // Energy exchange register
-  std::vector<std::pair<int, T>> energy_exchange_register;
+  // Number of agents of the classes of a relation on an awareness level
+  int getAwarenessCount(const State<T> &state, int relation, 
+      int level) const;
 
-  // Verbosity level
-  int verbosity;
+  // Closest agent of a relation on the given awareness levels, cached
+  int findClosestRelation(const State<T> &state, int relation, int levels);
 
-  // Search class object
-  Search<T> search_memory;
-
-  // Simulation parameters
-  SimulationParameters<T> &sim_params;
-
-  // Agent classes  
-  std::vector<AgentClass<T>> &agent_classes;
+  // Move towards or away from a target found by a query, no move if the
+  // target id is negative
+  Point3D<T> approachTarget(const State<T> &state, int target_id, T scale);
+  Point3D<T> avoidTarget(const State<T> &state, int target_id, T scale);
 
   // CreateMove
   Point3D<T> createMove(const State<T> &state);
 
-  
-  // Move strategies
-  Point3D<T> moveStrategy0(const State<T> &state);
-  Point3D<T> moveStrategy1(const State<T> &state);
-  Point3D<T> moveStrategy2(const State<T> &state);
-  Point3D<T> moveStrategy3(const State<T> &state);
-  Point3D<T> moveStrategy4(const State<T> &state);
-  Point3D<T> moveStrategy5(const State<T> &state);
-  Point3D<T> moveStrategy6(const State<T> &state);
-  Point3D<T> moveStrategy7(const State<T> &state);
-  Point3D<T> moveStrategy8(const State<T> &state);
+  // Update position and create move with the strategy fixed at compile 
+  // time, DYNAMIC_STRATEGY selects the strategy from the state
+  template <int strategy>
+  void updatePositionStrategy(const State<T> &state, State<T> &new_state);
+  template <int strategy>
+  Point3D<T> createMoveStrategy(const State<T> &state);
+
+  // Batch kernel of updatePositions for one strategy
+  template <int strategy>
+  static void updatePositionsStrategy(std::vector<Agent<T>> &agents, 
+      const State<T> &state, State<T> &new_state, 
+      const int *ids, int num_ids);
+
 
 
   // Approach closest food source
@@ -191,7 +180,6 @@ class Agent
 
   // Stay
   Point3D<T> stay();
-  void stay(const State<T> &state, State<T> &new_state);
 
   // Move randomly
   Point3D<T> randomMove(const State<T> &state);
@@ -247,27 +235,28 @@ class Agent
   int findClosest(const State<T> &state, 
       const std::vector<int> &target_classes);
 
-  // Find closest agent of a given agent class, which at least hears one agent
-  // of the given agent classes, return the index
-  int findClosestContact(const State<T> &state, int &class_id, 
-      const std::vector<int> &audible_classes);
-  int findClosestReachable(const State<T> &state, int &class_id,
-      const std::vector<int> &audible_classes);
-  int findClosestAudible(const State<T> &state, int &class_id,
-      const std::vector<int> &audible_classes);
-  int findClosestAware(const State<T> &state, int class_id,
-      const std::vector<int> &audible_classes);
+  // Find closest agent of the given agent classes, whose bit in the bit
+  // packed mask hears is set, e.g. a row of State::hears_food, the mask
+  // is not used if hears is NULL, return the index
   int findClosest(const State<T> &state, 
       const std::vector<int> &target_classes, 
-      const std::vector<int> &audible_classes,
-      bool two_masks = false);
+      const uint64_t *hears);
+
+  // Find closest agent of the given agent classes in a single pass,
+  // levels is a combination of AWARENESS_* flags, for each class the
+  // closest agent of the first level with agents is taken, classes
+  // without agents on these levels are skipped using the agent to class
+  // counts, return the index
+  int findClosest(const State<T> &state, 
+      const std::vector<int> &target_classes, int levels,
+      const uint64_t *hears);
 
   // Approach closest of a given class in awareness range
   Point3D<T> approachClosest(const State<T> &state, 
       const std::vector<int> &target_classes, T scale);
   Point3D<T> approachClosest(const State<T> &state, 
       const std::vector<int> &target_classes, 
-      const std::vector<int> &audible_classes,
+      const uint64_t *hears,
       T scale);
 
   // Avoid closest of a given class in awareness range
@@ -278,10 +267,7 @@ class Agent
   void boundaryControl(Point3D<T> &pos);
 
   // Init search
-  void initSearch(
-      int class_id,
-      SimulationParameters<T> &sim_params, 
-      std::mt19937 &gen);
+  void initSearch(int class_id);
 
   // Register for energy exchange
   void registerForEnergyExchange(int &other_id, T &amount);
@@ -293,6 +279,13 @@ class Agent
   // Respawn, completely overrides all other updates
   void respawn(const State<T> &state, State<T> &new_state, const int &class_id);
 
+  // Set the properties of a new agent of the class p
+  void initClassProperties(State<T> &new_state, 
+      const AgentClassParameters<T> &p);
+
+  // Free the slot of the agent, it stays at its last position
+  void vacate(State<T> &new_state);
+
   // Prevent overshooting
   void preventOvershooting(const State<T> &state, const Point3D<T> &move);
 
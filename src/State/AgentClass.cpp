@@ -1,4 +1,6 @@
 #include "AgentClass.h"
+#include "MaskedArgmin.h"
+#include "AgentData.h"
 
 template <typename T>
 AgentClass<T>::AgentClass(
@@ -66,310 +68,6 @@ int AgentClass<T>::getId()
   return params.id;
 }
 
-template <typename T>
-int AgentClass<T>::findMin(T *data, int *mask)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      if (data[i] < min){
-        index = i;
-        min = data[i];
-      }
-    }
-  }
-
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: Returning the index: " 
-      << index << std::endl;
-  }
-#endif
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMin(T *data, int *mask, int *mask2)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i] && mask2[i]){
-      if (data[i] < min){
-        index = i;
-        min = data[i];
-      }
-    }
-  }
-
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 2){
-    std::cout << "AgentClass::findMin: Returning the index: " 
-      << index << std::endl;
-  }
-#endif
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMin(T *data, int *mask, int *mask2, 
-    const std::vector<int> &class_ids)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      bool class_mask = false;
-      for (int j = 0; j < class_ids.size(); j++){
-        int class_id = class_ids[j];
-        if (mask2[class_id*sim_params.num_agents_total + i]){
-          class_mask = true;
-        }
-      }
-      if (class_mask){
-        if (data[i] < min){
-          index = i;
-          min = data[i];
-        }
-      }
-    }
-  }
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 2){
-    std::cout << "AgentClass::findMin: Returning the index: " 
-      << index << std::endl;
-  }
-#endif
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMin(int *data, int *mask)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      if (data[i] < min){
-        index = i;
-        min = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMin(int *data, int *mask, int *mask2)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i] && mask2[i]){
-      if (data[i] < min){
-        index = i;
-        min = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMin(int *data, int *mask, int *mask2, 
-    const std::vector<int> &class_ids)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMin: \
-      Finding the minimum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T min = std::numeric_limits<T>::max();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      bool class_mask = false;
-      for (int j = 0; j < class_ids.size(); j++){
-        int class_id = class_ids[j];
-        if (mask2[class_id*sim_params.num_agents_total + i]){
-          class_mask = true;
-        }
-      }
-      if (class_mask){
-        if (data[i] < min){
-          index = i;
-          min = data[i];
-        }
-      }
-    }
-  }
-
-  return index;
-}
-
-
-template <typename T>
-int AgentClass<T>::findMax(T *data, int *mask)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMax: \
-      Finding the maximum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T max = std::numeric_limits<T>::min();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      if (data[i] > max){
-        index = i;
-        max = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMax(T *data, int *mask, int *mask2)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMax: \
-      Finding the maximum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T max = std::numeric_limits<T>::min();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i] && mask2[i]){
-      if (data[i] > max){
-        index = i;
-        max = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMax(int *data, int *mask)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMax: \
-      Finding the maximum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T max = std::numeric_limits<T>::min();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i]){
-      if (data[i] > data[index]){
-        index = i;
-        max = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
-template <typename T>
-int AgentClass<T>::findMax(int *data, int *mask, int *mask2)
-{
-#ifdef DEBUG
-  if (global_params.getVerbosity() > 1){
-    std::cout << "AgentClass::findMax: \
-      Finding the maximum of the data" << std::endl;
-  }
-#endif
-
-  int index = -1;
-  T max = std::numeric_limits<T>::min();
-
-  // Iterate over the data
-  for (int i = params.start_index; i < params.stop_index; i++){
-    if (mask[i] && mask2[i]){
-      if (data[i] > data[index]){
-        index = i;
-        max = data[i];
-      }
-    }
-  }
-
-  return index;
-}
-
 template <typename T>
 Point3D<T> AgentClass<T>::findCOG(Point3D<T> *positions, T *weights, T *mask)
 {
@@ -399,8 +97,9 @@ template <typename T>
 int AgentClass<T>::getNumAudible(const State<T> &state, int agent_id) const
 {
   // Check audibility
-  int index = params.id * sim_params.num_agents_total + agent_id;
-  int num = state.audibility_agent_to_class[index];
+  // Count the set bits of the agent's row within the class range
+  const uint64_t *row = &state.audibility[agent_id * state.getMaskPitch()];
+  int num = countBits(row, params.start_index, params.stop_index);
 #ifdef DEBUG
   if (global_params.getVerbosity() > 1){
     std::cout << "AgentClass::getNumAudible: \
@@ -415,8 +114,9 @@ template <typename T>
 int AgentClass<T>::getNumReachable(const State<T> &state, int agent_id) const
 {
   // Check reachability
-  int index = params.id * sim_params.num_agents_total + agent_id;
-  int num = state.reachability_agent_to_class[index];
+  // Count the set bits of the agent's row within the class range
+  const uint64_t *row = &state.reachability[agent_id * state.getMaskPitch()];
+  int num = countBits(row, params.start_index, params.stop_index);
 #ifdef DEBUG
   if (global_params.getVerbosity() > 1){
     std::cout << "AgentClass::getNumReachable: \
@@ -431,8 +131,9 @@ template <typename T>
 int AgentClass<T>::getNumContact(const State<T> &state, int agent_id) const
 {
   // Check contact
-  int index = params.id * sim_params.num_agents_total + agent_id;
-  int num = state.contact_agent_to_class[index];
+  // Count the set bits of the agent's row within the class range
+  const uint64_t *row = &state.contact[agent_id * state.getMaskPitch()];
+  int num = countBits(row, params.start_index, params.stop_index);
 #ifdef DEBUG
   if (global_params.getVerbosity() > 1){
     std::cout << "AgentClass::getNumContact \
@@ -444,7 +145,56 @@ int AgentClass<T>::getNumContact(const State<T> &state, int agent_id) const
 }
 
 template <typename T>
-int AgentClass<T>::getNumMembers() const
+void AgentClass<T>::buildTree(const State<T> &state)
+{
+#ifdef DEBUG
+  if (global_params.getVerbosity() > 1){
+    std::cout << "AgentClass::buildTree: \
+      Building the spatial index of class " << params.id << std::endl;
+  }
+#endif
+  if (params.stop_index - params.start_index < CLASS_TREE_MIN_AGENTS){
+    tree.clear();
+    return;
+  }
+  tree.build(state, params.start_index, params.stop_index, 
+      sim_params.getPeriodicBox());
+}
+
+template <typename T>
+int AgentClass<T>::findClosest(const State<T> &state, int agent_id, 
+    int level, const uint64_t *hears) const
+{
+  const typename State<T>::distance_type *row = 
+    &state.distances_agent_to_agent[agent_id * state.getPitch()];
+  const int m = agent_id * state.getMaskPitch();
+
+  // Mask of the level and the distance all its agents are closer than
+  const uint64_t *mask;
+  T radius;
+  if (level == AWARENESS_LEVEL_CONTACT){
+    mask = &state.contact[m];
+    radius = (T)0.5 * (state.sizes[agent_id] + tree.getMaxSize());
+  } else if (level == AWARENESS_LEVEL_REACHABLE){
+    mask = &state.reachability[m];
+    radius = state.movespeed[agent_id];
+  } else {
+    mask = &state.audibility[m];
+    radius = tree.getMaxAudibilityThreshold();
+  }
+
+  if (!tree.isBuiltFor(state)){
+    return maskedArgmin(row, mask, hears, 
+        params.start_index, params.stop_index);
+  }
+  return tree.findMin(state.positions[agent_id], radius, row,
+      [mask, hears](int j){
+        return testBit(mask, j) && (hears == NULL || testBit(hears, j));
+      });
+}
+
+template <typename T>
+int AgentClass<T>::getNumMembers(const State<T> &state) const
 {
 #ifdef DEBUG
   if (global_params.getVerbosity() > 1){
@@ -453,7 +203,15 @@ int AgentClass<T>::getNumMembers() const
   }
 #endif
 
-  return params.num_agents;
+  // Members are the active agents, like in the class averages of the
+  // state machine
+  int num_members = 0;
+  for (int i = params.start_index; i < params.stop_index; i++){
+    if (isActive(state.status[i])){
+      num_members++;
+    }
+  }
+  return num_members;
 }
 
 template <typename T>
@@ -501,18 +259,22 @@ void AgentClass<T>::summarize(const State<T> &state) const
   // Calculate the inverse temporal scaling factor
   T inv_temporal_scaling_factor = 1.0 / sim_params.getDt();
 
-  // Get the number of agents
-  int num_agents = getNumMembers();
-  std::cout << "  Number of agents:   " << num_agents << std::endl;
-  
   // Get the start and stop indices
   int start_index = getStartIndex();
   int stop_index = getStopIndex();
 
+  // Count the active agents, dead agents and free slots are left out
+  int num_agents = getNumMembers(state);
+  T sum_energy = 0.0;
+  for (int i = start_index; i < stop_index; i++){
+    if (isActive(state.status[i])){
+      sum_energy += state.energy[i];
+    }
+  }
+  std::cout << "  Number of agents:   " << num_agents << std::endl;
 
   // Calculate the average energy
-  T avg_energy;
-  state.calculateAverage(state.energy, start_index, stop_index, avg_energy);
+  T avg_energy = (num_agents > 0) ? sum_energy / (T)num_agents : 0.0;
   std::cout << "  Average energy:     " << avg_energy << std::endl;
 
   /*
@@ -5,6 +5,11 @@
 #include "SimulationParameters.h"
 #include "GlobalParameters.h"
 #include "State.h"
+#include "ClassTree.h"
+
+// Members a class needs at least for a spatial index, the masked argmin
+// over the distance row is faster for smaller classes
+#define CLASS_TREE_MIN_AGENTS 512
 
 /* Used to retrieve class metrics and perform class reduction operations */
 
@@ -31,21 +36,6 @@ class AgentClass
   // Get the id of the agent class
   int getId();
 
-  // Reductions, using a mask, return the index of the min, max
-  int findMin(T *data, int *mask);
-  int findMin(T *data, int *mask, int *mask2);
-  int findMin(T *data, int *mask, int *mask2, 
-      const std::vector<int> &class_ids);
-  int findMin(int *data, int *mask);
-  int findMin(int *data, int *mask, int *mask2);
-  int findMin(int *data, int *mask, int *mask2, 
-      const std::vector<int> &class_ids);
-  int findMax(T *data, int *mask);
-  int findMax(T *data, int *mask, int *mask2);
-  int findMax(int *data, int *mask);
-  int findMax(int *data, int *mask, int *mask2);
-  
-
   // Find the center of gravity, using a mask and weights
   Point3D<T> findCOG(Point3D<T> *positions, T *weights, T *mask); 
 
@@ -60,8 +50,20 @@ class AgentClass
   // a given agent
   int getNumContact(const State<T> &state, int agent_id) const;
 
-  // Get the number of class members
-  int getNumMembers() const;
+  // Build the spatial index of the class from the positions of the
+  // state, the index is dropped if the class is too small
+  void buildTree(const State<T> &state);
+
+  // Closest agent of the class on the awareness level of agent_id,
+  // whose bit in hears is set unless hears is NULL, the same as the
+  // masked argmin over the class range of the distance row, the spatial
+  // index is used if it was built from the state, return the index
+  int findClosest(const State<T> &state, int agent_id, int level,
+      const uint64_t *hears) const;
+
+  // Get the number of class members of the state, the active agents
+  // of the class
+  int getNumMembers(const State<T> &state) const;
 
   // Get start and stop indices
   int getStartIndex() const;
@@ -81,6 +83,9 @@ class AgentClass
   // Parameters of the agent class
   const AgentClassParameters<T> &params;
 
+  // Spatial index of the members
+  ClassTree<T> tree;
+
 };
 
 
@@ -0,0 +1,109 @@
+#include "AgentData.h"
+
+template <typename T>
+AgentData<T>::AgentData(
+    SimulationParameters<T> &sim_params,
+    std::vector<Agent<T>> &agents,
+    std::vector<AgentClass<T>> &agent_classes,
+    AgentMetrics<T> &agent_metrics,
+    std::mt19937 &gen,
+    std::uniform_real_distribution<T> &dist_uni,
+    std::uniform_real_distribution<T> &dist_x,
+    std::uniform_real_distribution<T> &dist_y,
+    std::uniform_real_distribution<T> &dist_z,
+    SearchState<T> &search_state)
+  : sim_params(sim_params), agents(agents), agent_classes(agent_classes),
+  agent_metrics(agent_metrics), gen(gen),
+  dist_uni(dist_uni), dist_x(dist_x), dist_y(dist_y), dist_z(dist_z),
+  search_state(search_state), verbosity(0), num_agents(0)
+{
+#ifdef DEBUG
+  std::cout << "AgentData::AgentData: Constructor" << std::endl;
+#endif
+}
+
+template <typename T>
+AgentData<T>::~AgentData()
+{
+#ifdef DEBUG
+  std::cout << "AgentData::~AgentData: Destructor" << std::endl;
+#endif
+}
+
+template <typename T>
+void AgentData<T>::init(int num_agents, int verbosity)
+{
+#ifdef DEBUG
+  std::cout << "AgentData::init: \
+    Initializing the data of " << num_agents << " agents" << std::endl;
+#endif
+
+  this->num_agents = num_agents;
+  this->verbosity = verbosity;
+
+  // Per agent fields
+  transition_state.assign(num_agents, Status::ALIVE);
+  born.assign(num_agents, 0);
+  exchange_pairs.clear();
+  exchange_offset.assign(num_agents, 0);
+  exchange_count.assign(num_agents, 0);
+  registered_pairs.clear();
+  registered_ids.clear();
+  awareness_valid.assign(num_agents, 0);
+  awareness_counts.assign(
+      (size_t)num_agents * NUM_RELATIONS * NUM_AWARENESS_LEVELS, 0);
+  awareness_closest.assign(
+      (size_t)num_agents * NUM_RELATIONS * (AWARENESS_ALL + 1), 
+      CLOSEST_UNKNOWN);
+}
+
+template <typename T>
+void AgentData<T>::invalidateAwareness()
+{
+  std::fill(awareness_valid.begin(), awareness_valid.end(), 0);
+}
+
+template <typename T>
+void AgentData<T>::registerExchange(int id, int other_id, T amount)
+{
+  registered_ids.push_back(id);
+  registered_pairs.push_back(std::make_pair(other_id, amount));
+}
+
+template <typename T>
+void AgentData<T>::groupExchanges()
+{
+  // Count the exchanges of every agent, the offsets are their prefix sum
+  std::fill(exchange_count.begin(), exchange_count.end(), 0);
+  for (int id : registered_ids){
+    exchange_count[id]++;
+  }
+  int offset = 0;
+  for (int i = 0; i < num_agents; i++){
+    exchange_offset[i] = offset;
+    offset += exchange_count[i];
+  }
+
+  // Scatter the pairs, the pairs of an agent keep their order
+  exchange_pairs.resize(registered_pairs.size());
+  std::fill(exchange_count.begin(), exchange_count.end(), 0);
+  for (size_t k = 0; k < registered_ids.size(); k++){
+    const int id = registered_ids[k];
+    exchange_pairs[exchange_offset[id] + exchange_count[id]++] = 
+      registered_pairs[k];
+  }
+  registered_ids.clear();
+  registered_pairs.clear();
+}
+
+template <typename T>
+void AgentData<T>::clearExchanges(int id)
+{
+  exchange_count[id] = 0;
+}
+
+// Explicit instantiation
+template struct AgentData<float>;
+template struct AgentData<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
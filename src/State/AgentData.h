@@ -0,0 +1,170 @@
+#ifndef AGENTDATA_H
+#define AGENTDATA_H
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "SimulationParameters.h"
+#include "AgentClass.h"
+#include "AgentMetrics.h"
+#include "SearchState.h"
+
+// Awareness levels of the closest agent queries, tried in this order
+#define AWARENESS_LEVEL_CONTACT 0
+#define AWARENESS_LEVEL_REACHABLE 1
+#define AWARENESS_LEVEL_AUDIBLE 2
+#define NUM_AWARENESS_LEVELS 3
+
+// Combinations of awareness levels
+#define AWARENESS_CONTACT (1 << AWARENESS_LEVEL_CONTACT)
+#define AWARENESS_REACHABLE (1 << AWARENESS_LEVEL_REACHABLE)
+#define AWARENESS_AUDIBLE (1 << AWARENESS_LEVEL_AUDIBLE)
+#define AWARENESS_AWARE (AWARENESS_REACHABLE | AWARENESS_AUDIBLE)
+#define AWARENESS_ALL (AWARENESS_CONTACT | AWARENESS_AWARE)
+
+// Closest agent of the awareness not queried yet
+#define CLOSEST_UNKNOWN -2
+
+// VACANT marks a free slot of a class, see Population
+enum class Status{
+  DEAD,
+  ALIVE,
+  ATTACKED,
+  VACANT
+};
+
+// Dead agents and free slots neither move nor perceive nor are perceived
+inline bool isActive(int status)
+{
+  return status != (int)Status::DEAD && status != (int)Status::VACANT;
+}
+
+template <typename T>
+class Agent;
+
+/*
+ * Data of the agents which is not part of the state: references shared
+ * by all agents and the mutable per agent fields as arrays indexed by
+ * the agent id. An agent object only holds its id and a reference to
+ * this table.
+ */
+template <typename T>
+struct AgentData
+{
+  // Constructor
+  AgentData(
+      SimulationParameters<T> &sim_params,
+      std::vector<Agent<T>> &agents,
+      std::vector<AgentClass<T>> &agent_classes,
+      AgentMetrics<T> &agent_metrics,
+      std::mt19937 &gen,
+      std::uniform_real_distribution<T> &dist_uni,
+      std::uniform_real_distribution<T> &dist_x,
+      std::uniform_real_distribution<T> &dist_y,
+      std::uniform_real_distribution<T> &dist_z,
+      SearchState<T> &search_state);
+
+  // Destructor
+  ~AgentData();
+
+  // Allocate the per agent fields of num_agents agents
+  void init(int num_agents, int verbosity);
+
+  // Invalidate the awareness of all agents, call after the derived
+  // quantities of the state have been updated
+  void invalidateAwareness();
+
+  // Index of the count of a relation on an awareness level and of the
+  // closest agent of a relation on a combination of awareness levels
+  int countIndex(int id, int relation, int level) const
+  {
+    return (id * NUM_RELATIONS + relation) * NUM_AWARENESS_LEVELS + level;
+  }
+  int closestIndex(int id, int relation, int levels) const
+  {
+    return (id * NUM_RELATIONS + relation) * (AWARENESS_ALL + 1) + levels;
+  }
+
+  // Register an exchange of amount with other_id at agent id
+  void registerExchange(int id, int other_id, T amount);
+
+  // Group the exchanges registered since the last call by agent, call
+  // after all agents registered
+  void groupExchanges();
+
+  // Remove the exchanges of agent id
+  void clearExchanges(int id);
+
+  /* Shared by all agents */
+
+  // Simulation parameters
+  SimulationParameters<T> &sim_params;
+
+  // All agents
+  std::vector<Agent<T>> &agents;
+
+  // Agent classes
+  std::vector<AgentClass<T>> &agent_classes;
+
+  // Agent metrics
+  AgentMetrics<T> &agent_metrics;
+
+  // Random number generator
+  std::mt19937 &gen;
+
+  // Distribution for random numbers
+  std::uniform_real_distribution<T> &dist_uni;
+  std::uniform_real_distribution<T> &dist_x;
+  std::uniform_real_distribution<T> &dist_y;
+  std::uniform_real_distribution<T> &dist_z;
+
+  // Search memory of all agents
+  SearchState<T> &search_state;
+
+  // Verbosity level
+  int verbosity;
+
+  // Number of agents
+  int num_agents;
+
+  /* Per agent fields, indexed by the agent id */
+
+  // Transition state, not necessaryly equal to the status, only
+  // relevant within one transition, currently
+  // for example used for respawn,
+  // thus death and rebirth are possible within one iteration;
+  //
+  // The status in the state object should only be changed by the
+  // updateStatus function, other functions should use the transition_state,
+  // updateStatus should handle the synchronization with the state object
+  std::vector<Status> transition_state;
+
+  // Agents born or respawned in the current step, they do not reproduce
+  // before the next step, see StateMachine::updatePopulation
+  std::vector<char> born;
+
+  // Energy exchange registers, pairs of the other agent and the amount,
+  // the pairs of agent i are exchange_pairs[exchange_offset[i]] to 
+  // exchange_pairs[exchange_offset[i]+exchange_count[i]-1]
+  std::vector<std::pair<int, T>> exchange_pairs;
+  std::vector<int> exchange_offset;
+  std::vector<int> exchange_count;
+
+  // Exchanges in the order of registration and the agents they were
+  // registered at, until groupExchanges
+  std::vector<std::pair<int, T>> registered_pairs;
+  std::vector<int> registered_ids;
+
+  // Awareness of food, friends and enemies, filled on first use after
+  // invalidateAwareness; the counts are indexed [agent][relation][level],
+  // the closest agents [agent][relation][combination of levels], see
+  // countIndex and closestIndex
+  std::vector<char> awareness_valid;
+  std::vector<int> awareness_counts;
+  std::vector<int> awareness_closest;
+};
+
+#endif // AGENTDATA_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,202 @@
+#include "ClassTree.h"
+
+template <typename T>
+ClassTree<T>::ClassTree()
+  : start(0), source(NULL), periodic(false), box{0.0, 0.0, 0.0},
+    max_audibility_threshold(0.0), max_size(0.0)
+{
+#ifdef DEBUG
+  /*
+  std::cout << "ClassTree::ClassTree: Constructor" << std::endl;
+  */
+#endif
+}
+
+template <typename T>
+ClassTree<T>::~ClassTree()
+{
+#ifdef DEBUG
+  /*
+  std::cout << "ClassTree::~ClassTree: Destructor" << std::endl;
+  */
+#endif
+}
+
+template <typename T>
+void ClassTree<T>::clear()
+{
+  nodes.clear();
+  ids.clear();
+  positions.clear();
+  active.clear();
+  start = 0;
+  source = NULL;
+  max_audibility_threshold = 0.0;
+  max_size = 0.0;
+}
+
+template <typename T>
+int ClassTree<T>::size() const
+{
+  return (int)ids.size();
+}
+
+template <typename T>
+bool ClassTree<T>::isBuiltFor(const State<T> &state) const
+{
+  return !nodes.empty() && source == state.positions;
+}
+
+template <typename T>
+T ClassTree<T>::getMaxAudibilityThreshold() const
+{
+  return max_audibility_threshold;
+}
+
+template <typename T>
+T ClassTree<T>::getMaxSize() const
+{
+  return max_size;
+}
+
+template <typename T>
+bool ClassTree<T>::isUnmoved(const State<T> &state, int start, int stop) const
+{
+  if (nodes.empty() || this->start != start 
+      || (int)positions.size() != stop - start){
+    return false;
+  }
+  for (int j = start; j < stop; j++){
+    const bool a = isActive(state.status[j]);
+    if (a != (bool)active[j - start]){
+      return false;
+    }
+    const Point3D<T> &p = positions[j - start];
+    const Point3D<T> &q = state.positions[j];
+    if (a && (p.x != q.x || p.y != q.y || p.z != q.z)){
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void ClassTree<T>::build(const State<T> &state, int start, int stop, 
+    const T *box)
+{
+  // The bounds are calculated in the queries, the nodes do not depend
+  // on the boundaries
+  periodic = box != NULL;
+  for (int d = 0; d < 3; d++){
+    this->box[d] = periodic ? box[d] : (T)0.0;
+  }
+
+  // The boxes only depend on the positions, the tree of agents which
+  // did not move is kept
+  if (isUnmoved(state, start, stop)){
+    source = state.positions;
+  } else {
+    clear();
+    if (stop <= start){
+      return;
+    }
+    this->start = start;
+    positions.assign(state.positions + start, state.positions + stop);
+    active.resize(stop - start);
+    for (int j = start; j < stop; j++){
+      active[j - start] = isActive(state.status[j]);
+    }
+    split(state.positions);
+    source = state.positions;
+  }
+
+  // The thresholds and sizes can change without a move
+  max_audibility_threshold = 0.0;
+  max_size = 0.0;
+  for (int j = start; j < stop; j++){
+    if (!isActive(state.status[j])){
+      continue;
+    }
+    max_audibility_threshold =
+      std::max(max_audibility_threshold, state.audibility_threshold[j]);
+    max_size = std::max(max_size, state.sizes[j]);
+  }
+}
+
+template <typename T>
+void ClassTree<T>::split(const Point3D<T> *points)
+{
+  const int stop = start + (int)positions.size();
+  ids.clear();
+  for (int j = start; j < stop; j++){
+    if (active[j - start]){
+      ids.push_back(j);
+    }
+  }
+  if (ids.empty()){
+    return;
+  }
+
+  // Split the nodes in the order they are created, the children of a
+  // node are appended next to each other
+  Node root;
+  root.begin = 0;
+  root.end = (int)ids.size();
+  root.left = -1;
+  nodes.push_back(root);
+  for (int n = 0; n < (int)nodes.size(); n++){
+    Node &node = nodes[n];
+    node.lo = points[ids[node.begin]];
+    node.hi = node.lo;
+    for (int k = node.begin; k < node.end; k++){
+      const Point3D<T> &q = points[ids[k]];
+      node.lo.x = std::min(node.lo.x, q.x);
+      node.lo.y = std::min(node.lo.y, q.y);
+      node.lo.z = std::min(node.lo.z, q.z);
+      node.hi.x = std::max(node.hi.x, q.x);
+      node.hi.y = std::max(node.hi.y, q.y);
+      node.hi.z = std::max(node.hi.z, q.z);
+    }
+    if (node.end - node.begin <= CLASS_TREE_LEAF_SIZE){
+      continue;
+    }
+
+    // Median of the widest axis
+    T extent[3] = {node.hi.x - node.lo.x, node.hi.y - node.lo.y,
+      node.hi.z - node.lo.z};
+    int axis = 0;
+    if (extent[1] > extent[axis]){
+      axis = 1;
+    }
+    if (extent[2] > extent[axis]){
+      axis = 2;
+    }
+    const int begin = node.begin;
+    const int end = node.end;
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(ids.begin() + begin, ids.begin() + mid,
+        ids.begin() + end, [points, axis](int a, int b){
+          Point3D<T> pa = points[a];
+          Point3D<T> pb = points[b];
+          return pa[axis] < pb[axis] || (pa[axis] == pb[axis] && a < b);
+        });
+
+    // The reference to the node is invalid after the push
+    Node left;
+    left.begin = begin;
+    left.end = mid;
+    left.left = -1;
+    Node right = left;
+    right.begin = mid;
+    right.end = end;
+    nodes[n].left = (int)nodes.size();
+    nodes.push_back(left);
+    nodes.push_back(right);
+  }
+}
+
+// Explicit instantiation
+template class ClassTree<float>;
+template class ClassTree<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,196 @@
+#ifndef CLASSTREE_H
+#define CLASSTREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Point3D.h"
+#include "State.h"
+#include "AgentData.h"
+#include "helpers.h"
+
+// Agents per leaf at most
+#define CLASS_TREE_LEAF_SIZE 16
+
+// Depth of the tree at most, the leaves hold at least half of
+// CLASS_TREE_LEAF_SIZE agents
+#define CLASS_TREE_MAX_DEPTH 40
+
+// Relative underestimate of the distance bounds of the nodes, covers
+// the rounding of the distances calculated by the kernels
+#define CLASS_TREE_SLACK 1e-5
+
+/*
+ * k-d tree over the positions of the agents of one class, the agents
+ * start to stop-1 of a state. The nodes split the agents at the median
+ * of the widest axis of their bounding box, the two children of a node
+ * are adjacent. The tree of a class whose agents did not move, e.g.
+ * plants, is kept from step to step. In a periodic world the bounds of
+ * the nodes are the ones of the closest images. Dead agents and free
+ * slots are left out, the masks never accept them.
+ *
+ * findMin returns the same agent as the masked argmin over the class
+ * range of a distance row: the accepted agent with the smallest stored
+ * distance, ties go to the lower index. It only visits the nodes whose
+ * bounding box is within the radius and could hold a closer agent, the
+ * stored distances are the ones of the row, not recalculated.
+ */
+template <typename T>
+class ClassTree
+{
+ public:
+
+  typedef typename State<T>::distance_type distance_type;
+
+  // Constructor
+  ClassTree();
+
+  // Destructor
+  ~ClassTree();
+
+  // Build the tree over the agents start to stop-1 of the state, the
+  // nodes are kept if none of the agents moved since the last build,
+  // box holds the half sizes of a periodic world, NULL if the world is
+  // not periodic
+  void build(const State<T> &state, int start, int stop, const T *box);
+
+  // Remove all agents
+  void clear();
+
+  // Number of agents in the tree
+  int size() const;
+
+  // Test if the tree was built from the positions of the state
+  bool isBuiltFor(const State<T> &state) const;
+
+  // Largest audibility threshold and size of the agents in the tree
+  T getMaxAudibilityThreshold() const;
+  T getMaxSize() const;
+
+  // Index of the accepted agent with the smallest distance in data
+  // within radius of p, ties go to the lower index, -1 if none; the
+  // agents at a distance of radius or more must not be accepted
+  template <typename Accept>
+  int findMin(const Point3D<T> &p, T radius, const distance_type *data,
+      Accept accept) const
+  {
+    int index = -1;
+    distance_type min = 0;
+    if (nodes.empty()){
+      return index;
+    }
+    int stack[2*CLASS_TREE_MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0){
+      const Node &node = nodes[stack[--top]];
+
+      // Skip the node if all its agents are beyond the radius or
+      // farther than the closest agent so far
+      T bound = lowerBound(node, p) * (T)(1.0 - CLASS_TREE_SLACK);
+      if (bound > radius){
+        continue;
+      }
+      if (index >= 0 && State<T>::encodeDistance(bound) > min){
+        continue;
+      }
+
+      if (node.left < 0){
+        for (int k = node.begin; k < node.end; k++){
+          const int j = ids[k];
+          if (!accept(j)){
+            continue;
+          }
+          if (index < 0 || data[j] < min || (data[j] == min && j < index)){
+            index = j;
+            min = data[j];
+          }
+        }
+        continue;
+      }
+
+      // Visit the nearer child first
+      const Node &left = nodes[node.left];
+      const Node &right = nodes[node.left + 1];
+      if (lowerBound(left, p) <= lowerBound(right, p)){
+        stack[top++] = node.left + 1;
+        stack[top++] = node.left;
+      } else {
+        stack[top++] = node.left;
+        stack[top++] = node.left + 1;
+      }
+    }
+    return index;
+  }
+
+ private:
+
+  // Node of the agents ids[begin] to ids[end-1] within the box lo, hi,
+  // the children are nodes left and left+1, left is -1 for a leaf
+  struct Node
+  {
+    Point3D<T> lo;
+    Point3D<T> hi;
+    int begin;
+    int end;
+    int left;
+  };
+
+  // Test if the active agents start to stop-1 are the ones of the last
+  // build and where they were then
+  bool isUnmoved(const State<T> &state, int start, int stop) const;
+
+  // Split the nodes over the active agents down to the leaves, points
+  // are the positions of the state
+  void split(const Point3D<T> *points);
+
+  // Distance of the coordinate v to the interval lo, hi of axis d, 0
+  // inside, the closest image in a periodic world
+  T gap(T v, T lo, T hi, int d) const
+  {
+    T g = std::max(std::max(lo - v, v - hi), (T)0.0);
+    if (periodic){
+      const T period = 2 * box[d];
+      g = std::min(g, std::max(std::max(lo - (v + period), 
+              (v + period) - hi), (T)0.0));
+      g = std::min(g, std::max(std::max(lo - (v - period), 
+              (v - period) - hi), (T)0.0));
+    }
+    return g;
+  }
+
+  // Distance of p to the box of the node, 0 inside
+  T lowerBound(const Node &node, const Point3D<T> &p) const
+  {
+    T dx = gap(p.x, node.lo.x, node.hi.x, 0);
+    T dy = gap(p.y, node.lo.y, node.hi.y, 1);
+    T dz = gap(p.z, node.lo.z, node.hi.z, 2);
+    return std::sqrt(dx*dx + dy*dy + dz*dz);
+  }
+
+  // Nodes, the root is node 0
+  std::vector<Node> nodes;
+
+  // Agent ids in the order of the leaves
+  std::vector<int> ids;
+
+  // First agent, positions and active flags of the agents at the last
+  // build
+  int start;
+  std::vector<Point3D<T>> positions;
+  std::vector<char> active;
+
+  // Positions the tree was built from, moving a state keeps them
+  const Point3D<T> *source;
+
+  // Periodic world of half sizes box
+  bool periodic;
+  T box[3];
+
+  // Largest audibility threshold and size of the agents
+  T max_audibility_threshold;
+  T max_size;
+};
+
+#endif // CLASSTREE_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,315 @@
+/*
+ * Masked argmin over a bit packed mask, the kernel behind the closest
+ * agent queries. Returns the index of the minimum of data[i] for the
+ * indices i in [start, stop) whose bit is set in mask and, if given, in
+ * mask2, ties go to the lower index, -1 if no bit is set.
+ *
+ * On x86 the float and double kernels use AVX-512 or AVX2, selected at
+ * runtime from the cpu features, all other cases use the scalar kernel.
+ */
+#ifndef MASKEDARGMIN_H
+#define MASKEDARGMIN_H
+
+#include "helpers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MASKED_ARGMIN_X86
+#include <immintrin.h>
+#endif
+
+#define SIMD_SCALAR 0
+#define SIMD_AVX2 1
+#define SIMD_AVX512 2
+
+// Scalar kernel, iterates over the set bits only
+template <typename D>
+int static maskedArgminScalar(const D *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  int index = -1;
+  D min = std::numeric_limits<D>::max();
+  if (start >= stop){
+    return index;
+  }
+  for (int w = start / BITS_PER_WORD; w <= (stop - 1) / BITS_PER_WORD; w++){
+    uint64_t word = mask[w] & maskWordRange(w, start, stop);
+    if (mask2 != NULL){
+      word &= mask2[w];
+    }
+    while (word){
+      int i = w * BITS_PER_WORD + __builtin_ctzll(word);
+      if (data[i] < min){
+        index = i;
+        min = data[i];
+      }
+      word &= word - 1;
+    }
+  }
+  return index;
+}
+
+// Merge the partial minima of the lanes into index, min
+template <typename D, typename I>
+void static mergeArgmin(const D *lane_min, const I *lane_index, int lanes,
+    int &index, D &min)
+{
+  for (int l = 0; l < lanes; l++){
+    if (lane_index[l] < 0){
+      continue;
+    }
+    if (index < 0 || lane_min[l] < min
+        || (lane_min[l] == min && lane_index[l] < index)){
+      index = (int)lane_index[l];
+      min = lane_min[l];
+    }
+  }
+}
+
+// Merge the scalar result on [start, stop) into index, min
+template <typename D>
+void static mergeArgminScalar(const D *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop, int &index, D &min)
+{
+  int i = maskedArgminScalar(data, mask, mask2, start, stop);
+  if (i < 0){
+    return;
+  }
+  if (index < 0 || data[i] < min || (data[i] == min && i < index)){
+    index = i;
+    min = data[i];
+  }
+}
+
+// Bits [i, i + n) of the masks, i is a multiple of n
+uint64_t static maskChunk(const uint64_t *mask, const uint64_t *mask2,
+    int i, int n)
+{
+  uint64_t word = mask[i / BITS_PER_WORD];
+  if (mask2 != NULL){
+    word &= mask2[i / BITS_PER_WORD];
+  }
+  return (word >> (i % BITS_PER_WORD)) & ((uint64_t(1) << n) - 1);
+}
+
+#ifdef MASKED_ARGMIN_X86
+
+// Supported simd level of the cpu, detected once
+int static simdLevel()
+{
+  static const int level = []{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")){
+      return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")){
+      return SIMD_AVX2;
+    }
+    return SIMD_SCALAR;
+  }();
+  return level;
+}
+
+__attribute__((target("avx2")))
+int static maskedArgminAvx2(const float *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  int index = -1;
+  float min = std::numeric_limits<float>::max();
+
+  // Scalar head up to the first chunk boundary
+  int i = std::min(stop, (start + 7) & ~7);
+  mergeArgminScalar(data, mask, mask2, start, i, index, min);
+
+  // Blend the masked lanes which are below the running minimum
+  const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256i lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256 vmin = _mm256_set1_ps(std::numeric_limits<float>::max());
+  __m256i vindex = _mm256_set1_epi32(-1);
+  for (; i + 8 <= stop; i += 8){
+    int bits = (int)maskChunk(mask, mask2, i, 8);
+    if (bits == 0){
+      continue;
+    }
+    __m256i lanes = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(bits), lane_bits), lane_bits);
+    __m256 x = _mm256_loadu_ps(&data[i]);
+    __m256 less = _mm256_and_ps(_mm256_cmp_ps(x, vmin, _CMP_LT_OQ),
+        _mm256_castsi256_ps(lanes));
+    vmin = _mm256_blendv_ps(vmin, x, less);
+    vindex = _mm256_blendv_epi8(vindex,
+        _mm256_add_epi32(_mm256_set1_epi32(i), lane_offsets),
+        _mm256_castps_si256(less));
+  }
+
+  // Horizontal reduction
+  alignas(32) float lane_min[8];
+  alignas(32) int lane_index[8];
+  _mm256_store_ps(lane_min, vmin);
+  _mm256_store_si256((__m256i *)lane_index, vindex);
+  mergeArgmin(lane_min, lane_index, 8, index, min);
+
+  // Scalar tail
+  mergeArgminScalar(data, mask, mask2, i, stop, index, min);
+  return index;
+}
+
+__attribute__((target("avx2")))
+int static maskedArgminAvx2(const double *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  int index = -1;
+  double min = std::numeric_limits<double>::max();
+
+  // Scalar head up to the first chunk boundary
+  int i = std::min(stop, (start + 3) & ~3);
+  mergeArgminScalar(data, mask, mask2, start, i, index, min);
+
+  // Blend the masked lanes which are below the running minimum
+  const __m256i lane_bits = _mm256_setr_epi64x(1, 2, 4, 8);
+  const __m256i lane_offsets = _mm256_setr_epi64x(0, 1, 2, 3);
+  __m256d vmin = _mm256_set1_pd(std::numeric_limits<double>::max());
+  __m256i vindex = _mm256_set1_epi64x(-1);
+  for (; i + 4 <= stop; i += 4){
+    int bits = (int)maskChunk(mask, mask2, i, 4);
+    if (bits == 0){
+      continue;
+    }
+    __m256i lanes = _mm256_cmpeq_epi64(
+        _mm256_and_si256(_mm256_set1_epi64x(bits), lane_bits), lane_bits);
+    __m256d x = _mm256_loadu_pd(&data[i]);
+    __m256d less = _mm256_and_pd(_mm256_cmp_pd(x, vmin, _CMP_LT_OQ),
+        _mm256_castsi256_pd(lanes));
+    vmin = _mm256_blendv_pd(vmin, x, less);
+    vindex = _mm256_blendv_epi8(vindex,
+        _mm256_add_epi64(_mm256_set1_epi64x(i), lane_offsets),
+        _mm256_castpd_si256(less));
+  }
+
+  // Horizontal reduction
+  alignas(32) double lane_min[4];
+  alignas(32) int64_t lane_index[4];
+  _mm256_store_pd(lane_min, vmin);
+  _mm256_store_si256((__m256i *)lane_index, vindex);
+  mergeArgmin(lane_min, lane_index, 4, index, min);
+
+  // Scalar tail
+  mergeArgminScalar(data, mask, mask2, i, stop, index, min);
+  return index;
+}
+
+__attribute__((target("avx512f")))
+int static maskedArgminAvx512(const float *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  int index = -1;
+  float min = std::numeric_limits<float>::max();
+
+  // Scalar head up to the first chunk boundary
+  int i = std::min(stop, (start + 15) & ~15);
+  mergeArgminScalar(data, mask, mask2, start, i, index, min);
+
+  // The mask chunk is the lane mask of the compare
+  const __m512i lane_offsets = _mm512_setr_epi32(
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m512 vmin = _mm512_set1_ps(std::numeric_limits<float>::max());
+  __m512i vindex = _mm512_set1_epi32(-1);
+  for (; i + 16 <= stop; i += 16){
+    __mmask16 bits = (__mmask16)maskChunk(mask, mask2, i, 16);
+    if (bits == 0){
+      continue;
+    }
+    __m512 x = _mm512_loadu_ps(&data[i]);
+    __mmask16 less = _mm512_mask_cmp_ps_mask(bits, x, vmin, _CMP_LT_OQ);
+    vmin = _mm512_mask_mov_ps(vmin, less, x);
+    vindex = _mm512_mask_mov_epi32(vindex, less,
+        _mm512_add_epi32(_mm512_set1_epi32(i), lane_offsets));
+  }
+
+  // Horizontal reduction
+  alignas(64) float lane_min[16];
+  alignas(64) int lane_index[16];
+  _mm512_store_ps(lane_min, vmin);
+  _mm512_store_si512(lane_index, vindex);
+  mergeArgmin(lane_min, lane_index, 16, index, min);
+
+  // Scalar tail
+  mergeArgminScalar(data, mask, mask2, i, stop, index, min);
+  return index;
+}
+
+__attribute__((target("avx512f")))
+int static maskedArgminAvx512(const double *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  int index = -1;
+  double min = std::numeric_limits<double>::max();
+
+  // Scalar head up to the first chunk boundary
+  int i = std::min(stop, (start + 7) & ~7);
+  mergeArgminScalar(data, mask, mask2, start, i, index, min);
+
+  // The mask chunk is the lane mask of the compare
+  const __m512i lane_offsets = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  __m512d vmin = _mm512_set1_pd(std::numeric_limits<double>::max());
+  __m512i vindex = _mm512_set1_epi64(-1);
+  for (; i + 8 <= stop; i += 8){
+    __mmask8 bits = (__mmask8)maskChunk(mask, mask2, i, 8);
+    if (bits == 0){
+      continue;
+    }
+    __m512d x = _mm512_loadu_pd(&data[i]);
+    __mmask8 less = _mm512_mask_cmp_pd_mask(bits, x, vmin, _CMP_LT_OQ);
+    vmin = _mm512_mask_mov_pd(vmin, less, x);
+    vindex = _mm512_mask_mov_epi64(vindex, less,
+        _mm512_add_epi64(_mm512_set1_epi64(i), lane_offsets));
+  }
+
+  // Horizontal reduction
+  alignas(64) double lane_min[8];
+  alignas(64) int64_t lane_index[8];
+  _mm512_store_pd(lane_min, vmin);
+  _mm512_store_si512(lane_index, vindex);
+  mergeArgmin(lane_min, lane_index, 8, index, min);
+
+  // Scalar tail
+  mergeArgminScalar(data, mask, mask2, i, stop, index, min);
+  return index;
+}
+
+// Dispatch the floating point kernels on the simd level of the cpu
+template <typename D>
+int static maskedArgminSimd(const D *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+  switch (simdLevel()){
+    case SIMD_AVX512:
+      return maskedArgminAvx512(data, mask, mask2, start, stop);
+    case SIMD_AVX2:
+      return maskedArgminAvx2(data, mask, mask2, start, stop);
+    default:
+      return maskedArgminScalar(data, mask, mask2, start, stop);
+  }
+}
+
+#endif
+
+template <typename D>
+int static maskedArgmin(const D *data, const uint64_t *mask,
+    const uint64_t *mask2, int start, int stop)
+{
+#ifdef MASKED_ARGMIN_X86
+  if constexpr (std::is_same<D, float>::value
+      || std::is_same<D, double>::value){
+    return maskedArgminSimd(data, mask, mask2, start, stop);
+  }
+#endif
+  return maskedArgminScalar(data, mask, mask2, start, stop);
+}
+
+#endif
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,253 @@
+/*
+ * Move strategies of the agents, composed at compile time from
+ * building blocks. Each block either decides the move of the agent and
+ * returns true, or returns false and leaves the decision to the next
+ * block of the strategy.
+ *
+ * New strategies are added by appending them to MoveStrategies, the
+ * position in the list is the strategy id used in the config files.
+ * New building blocks are added to MoveBlocks, which is a friend of
+ * Agent.
+ */
+#ifndef MOVESTRATEGIES_H
+#define MOVESTRATEGIES_H
+
+#include "Agent.h"
+#include "Point3D.h"
+#include "State.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+struct MoveBlocks
+{
+  // Do not move
+  struct Stay
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      move = Point3D<T>(0.0, 0.0, 0.0);
+      return true;
+    }
+  };
+
+  // If attacked by an enemy, do not move
+  struct StayIfAttacked
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (agent.attacked(state)){
+        move = Point3D<T>(0.0, 0.0, 0.0);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  // If at a food source, do not move
+  struct StayAtFood
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (agent.foodContact(state)){
+        move = Point3D<T>(0.0, 0.0, 0.0);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  // Avoid audible enemies
+  struct AvoidEnemies
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (agent.enemyAudible(state)){
+        move = agent.avoidClosestEnemies(state);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  // Approach the closest audible food source
+  struct ApproachFood
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (agent.foodAudible(state)){
+        move = agent.approachClosestFoodSource(state);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  // Approach the closest audible friends which hear food
+  struct FollowFriendsHearingFood
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (agent.friendAudible(state)){
+        move = agent.approachClosestFriendsHearingFood(state);
+        return !move.isZero();
+      }
+      return false;
+    }
+  };
+
+  // Approach friends which hear food, if none do, search when friends
+  // are reachable and approach audible friends otherwise
+  struct FollowFriends
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      if (!agent.friendAudible(state)){
+        return false;
+      }
+      move = agent.approachClosestFriendsHearingFood(state);
+      if (move.isZero()){
+        if (agent.friendReachable(state)){
+          move = agent.search(state);
+        } else {
+          move = agent.approachClosestFriends(state);
+        }
+      }
+      return true;
+    }
+  };
+
+  // Random walk using the search memory
+  struct Search
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      move = agent.search(state);
+      return true;
+    }
+  };
+
+  // Brownian motion
+  struct RandomMove
+  {
+    template <typename T>
+    static bool apply(Agent<T> &agent, const State<T> &state,
+        Point3D<T> &move)
+    {
+      move = agent.randomMove(state);
+      return true;
+    }
+  };
+};
+
+// A strategy tries its blocks in order, the first block which applies
+// decides the move, no move if none applies
+template <typename... Blocks>
+struct MoveStrategy
+{
+  template <typename T>
+  static Point3D<T> move(Agent<T> &agent, const State<T> &state)
+  {
+    Point3D<T> move(0.0, 0.0, 0.0);
+    (void)(Blocks::apply(agent, state, move) || ...);
+    return move;
+  }
+};
+
+// Registered strategies, indexed by the strategy id
+typedef std::tuple<
+  // 0: Do nothing
+  MoveStrategy<MoveBlocks::Stay>,
+
+  // 1: No communication, only search and approach food
+  MoveStrategy<
+    MoveBlocks::StayAtFood,
+    MoveBlocks::ApproachFood,
+    MoveBlocks::Search>,
+
+  // 2: Like 1, but approach friends which hear food
+  MoveStrategy<
+    MoveBlocks::StayAtFood,
+    MoveBlocks::ApproachFood,
+    MoveBlocks::FollowFriendsHearingFood,
+    MoveBlocks::Search>,
+
+  // 3: Like 2, but avoid enemies
+  MoveStrategy<
+    MoveBlocks::StayIfAttacked,
+    MoveBlocks::AvoidEnemies,
+    MoveBlocks::StayAtFood,
+    MoveBlocks::ApproachFood,
+    MoveBlocks::FollowFriendsHearingFood,
+    MoveBlocks::Search>,
+
+  // 4: Like 2, but stay close to friends, not ready yet, needs to
+  // compare old and new state to avoid infinite loops
+  MoveStrategy<
+    MoveBlocks::StayAtFood,
+    MoveBlocks::ApproachFood,
+    MoveBlocks::FollowFriends,
+    MoveBlocks::Search>,
+
+  // 5: Only avoid enemies
+  MoveStrategy<
+    MoveBlocks::AvoidEnemies,
+    MoveBlocks::Stay>,
+
+  // 6: Avoid enemies + strategy 1
+  MoveStrategy<
+    MoveBlocks::AvoidEnemies,
+    MoveBlocks::StayAtFood,
+    MoveBlocks::ApproachFood,
+    MoveBlocks::Search>,
+
+  // 7: Brownian motion
+  MoveStrategy<MoveBlocks::RandomMove>,
+
+  // 8: Search only
+  MoveStrategy<MoveBlocks::Search>
+  > MoveStrategies;
+
+// Strategy with the given id
+template <int strategy>
+using MoveStrategyAt = 
+  typename std::tuple_element<strategy, MoveStrategies>::type;
+
+// Number of registered strategies
+#define NUM_STRATEGIES ((int)std::tuple_size<MoveStrategies>::value)
+
+// Call f with std::integral_constant<int, id> of the registered strategy
+// id equal to strategy, return false if it is not registered
+template <int id = 0, typename F>
+bool dispatchStrategy(int strategy, F &&f)
+{
+  if constexpr (id < NUM_STRATEGIES){
+    if (strategy == id){
+      f(std::integral_constant<int, id>());
+      return true;
+    }
+    return dispatchStrategy<id + 1>(strategy, std::forward<F>(f));
+  } else {
+    return false;
+  }
+}
+
+#endif
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,291 @@
+#include "NeighborLists.h"
+
+template <typename T>
+NeighborLists<T>::NeighborLists()
+  : skin(0.0), periodic(false), box{0.0, 0.0, 0.0}, valid(false), 
+    num_builds(0)
+{
+#ifdef DEBUG
+  std::cout << "NeighborLists::NeighborLists: Constructor" << std::endl;
+#endif
+}
+
+template <typename T>
+NeighborLists<T>::~NeighborLists()
+{
+#ifdef DEBUG
+  std::cout << "NeighborLists::~NeighborLists: Destructor" << std::endl;
+#endif
+}
+
+template <typename T>
+void NeighborLists<T>::init(T skin, const T *box)
+{
+#ifdef DEBUG
+  std::cout << "NeighborLists::init: \
+    Skin " << skin << ", periodic " << (box != NULL) << std::endl;
+#endif
+  this->skin = skin;
+  periodic = box != NULL;
+  for (int d = 0; d < 3; d++){
+    this->box[d] = periodic ? box[d] : (T)0.0;
+  }
+  Point3D<T>::periods(this->box, period, inv_period);
+  num_builds = 0;
+  invalidate();
+}
+
+template <typename T>
+void NeighborLists<T>::invalidate()
+{
+  valid = false;
+}
+
+template <typename T>
+bool NeighborLists<T>::update(const State<T> &state)
+{
+  if (isValid(state)){
+    return false;
+  }
+  build(state);
+  return true;
+}
+
+template <typename T>
+int NeighborLists<T>::getNumBuilds() const
+{
+  return num_builds;
+}
+
+template <typename T>
+int NeighborLists<T>::getNumCandidates() const
+{
+  return (int)ids.size();
+}
+
+template <typename T>
+bool NeighborLists<T>::isValid(const State<T> &state) const
+{
+  const int num_agents = state.num_agents_total;
+  if (!valid || (int)positions.size() != num_agents){
+    return false;
+  }
+
+  // The distance of a pair changed by at most the sum of both
+  // displacements, the two largest ones bound all pairs
+  T first = 0.0;
+  T second = 0.0;
+  for (int i = 0; i < num_agents; i++){
+    // Inactive agents are in no list, an agent born, respawned or moved
+    // into a free slot since the build is missing
+    if (!isActive(state.status[i])){
+      continue;
+    }
+    if (!active[i] || radius(state, i) > radii[i]){
+      return false;
+    }
+    // An agent which left a periodic world on one side moved by the
+    // closest image
+    Point3D<T> p = positions[i];
+    T displacement = periodic 
+      ? p.distance(state.positions[i], period, inv_period) 
+      : p.distance(state.positions[i]);
+    if (displacement > first){
+      second = first;
+      first = displacement;
+    } else if (displacement > second){
+      second = displacement;
+    }
+  }
+  return first + second < skin;
+}
+
+template <typename T>
+void NeighborLists<T>::build(const State<T> &state)
+{
+  const int num_agents = state.num_agents_total;
+#ifdef DEBUG
+  std::cout << "NeighborLists::build: \
+    Building the lists of " << num_agents << " agents" << std::endl;
+#endif
+
+  positions.assign(state.positions, state.positions + num_agents);
+  radii.resize(num_agents);
+  active.resize(num_agents);
+  offsets.assign(num_agents + 1, 0);
+  ids.clear();
+  valid = true;
+  num_builds++;
+
+  // Only the active agents are sorted into the grid
+  std::vector<int> active_ids;
+  for (int i = 0; i < num_agents; i++){
+    active[i] = isActive(state.status[i]);
+    if (active[i]){
+      active_ids.push_back(i);
+    }
+  }
+  const int num_active = (int)active_ids.size();
+  if (num_active == 0){
+    return;
+  }
+
+  // Bounding box of the agents and the smallest radius plus skin
+  Point3D<T> lo = positions[active_ids[0]];
+  Point3D<T> hi = positions[active_ids[0]];
+  T min_reach = radius(state, active_ids[0]) + skin;
+  for (const int i : active_ids){
+    radii[i] = radius(state, i);
+    min_reach = std::min(min_reach, radii[i] + skin);
+    lo.x = std::min(lo.x, positions[i].x);
+    lo.y = std::min(lo.y, positions[i].y);
+    lo.z = std::min(lo.z, positions[i].z);
+    hi.x = std::max(hi.x, positions[i].x);
+    hi.y = std::max(hi.y, positions[i].y);
+    hi.z = std::max(hi.z, positions[i].z);
+  }
+
+  // The grid covers the agents, along the periodic axes the whole
+  // world, an axis without extent does not wrap
+  bool wraps[3];
+  T origin[3];
+  T extent[3];
+  for (int d = 0; d < 3; d++){
+    wraps[d] = periodic && box[d] > 0.0;
+    origin[d] = wraps[d] ? -box[d] : lo[d];
+    extent[d] = wraps[d] ? 2 * box[d] : hi[d] - lo[d];
+  }
+
+  // Cells of about one agent, not smaller than the smallest radius plus
+  // skin and not more than NEIGHBOR_CELLS_PER_AGENT per agent, the cells
+  // of a periodic grid tile the world
+  T volume = 1.0;
+  for (int d = 0; d < 3; d++){
+    volume *= std::max(extent[d], min_reach);
+  }
+  T h = std::max(min_reach, (T)std::cbrt(volume / num_active));
+  int dims[3];
+  T width[3];
+  long num_cells;
+  while (true){
+    num_cells = 1;
+    for (int d = 0; d < 3; d++){
+      if (wraps[d]){
+        dims[d] = std::max(1, (int)std::min(extent[d] / h, (T)num_active));
+        width[d] = extent[d] / dims[d];
+      } else {
+        dims[d] = (int)std::min(extent[d] / h, (T)num_active) + 1;
+        width[d] = h;
+      }
+      num_cells *= dims[d];
+    }
+    if (num_cells <= (long)NEIGHBOR_CELLS_PER_AGENT * num_active){
+      break;
+    }
+    h *= 2;
+  }
+
+  // Cells from c0 to c1 along d, in a periodic grid they are taken
+  // modulo dims, at most once
+  auto rangeOf = [&](T v0, T v1, int d, int &c0, int &c1){
+    if (wraps[d]){
+      c0 = (int)std::floor((v0 - origin[d]) / width[d]);
+      c1 = (int)std::floor((v1 - origin[d]) / width[d]);
+      if (c1 - c0 >= dims[d]){
+        c0 = 0;
+        c1 = dims[d] - 1;
+      }
+    } else {
+      c0 = std::max(0, std::min((int)((v0 - origin[d]) / width[d]), 
+            dims[d] - 1));
+      c1 = std::max(0, std::min((int)((v1 - origin[d]) / width[d]), 
+            dims[d] - 1));
+    }
+  };
+  auto wrap = [&](int c, int d){
+    return wraps[d] ? ((c % dims[d]) + dims[d]) % dims[d] : c;
+  };
+
+  // Sort the agents into the cells
+  std::vector<int> cell(num_agents);
+  cell_start.assign(num_cells + 1, 0);
+  for (const int i : active_ids){
+    int c[3];
+    for (int d = 0; d < 3; d++){
+      int c1;
+      rangeOf(positions[i][d], positions[i][d], d, c[d], c1);
+      c[d] = wrap(c[d], d);
+    }
+    cell[i] = (c[2] * dims[1] + c[1]) * dims[0] + c[0];
+    cell_start[cell[i] + 1]++;
+  }
+  for (long c = 0; c < num_cells; c++){
+    cell_start[c + 1] += cell_start[c];
+  }
+  cell_agents.resize(num_active);
+  std::vector<int> cursor(cell_start.begin(), cell_start.end() - 1);
+  for (const int i : active_ids){
+    cell_agents[cursor[cell[i]]++] = i;
+  }
+
+  // Each pair is found from the agent with the larger radius, ties go
+  // to the lower index
+  pairs.clear();
+  for (const int i : active_ids){
+    Point3D<T> p = positions[i];
+    const T reach = radii[i] + skin;
+    int c0[3];
+    int c1[3];
+    for (int d = 0; d < 3; d++){
+      rangeOf(p[d] - reach, p[d] + reach, d, c0[d], c1[d]);
+    }
+    for (int cz = c0[2]; cz <= c1[2]; cz++){
+      for (int cy = c0[1]; cy <= c1[1]; cy++){
+        for (int cx = c0[0]; cx <= c1[0]; cx++){
+          const long c = ((long)wrap(cz, 2) * dims[1] + wrap(cy, 1)) 
+            * dims[0] + wrap(cx, 0);
+          for (int k = cell_start[c]; k < cell_start[c + 1]; k++){
+            const int j = cell_agents[k];
+            if (j == i || radii[j] > radii[i]
+                || (radii[j] == radii[i] && j < i)){
+              continue;
+            }
+            const Point3D<T> q = periodic 
+              ? p.image(positions[j], period, inv_period) : positions[j];
+            T d2 = (p.x - q.x)*(p.x - q.x) + (p.y - q.y)*(p.y - q.y)
+              + (p.z - q.z)*(p.z - q.z);
+            if (d2 < reach * reach){
+              pairs.push_back(std::make_pair(i, j));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Both agents of a pair are candidates of each other
+  for (const std::pair<int, int> &pair : pairs){
+    offsets[pair.first + 1]++;
+    offsets[pair.second + 1]++;
+  }
+  for (int i = 0; i < num_agents; i++){
+    offsets[i + 1] += offsets[i];
+  }
+  ids.resize(offsets[num_agents]);
+  cursor.assign(offsets.begin(), offsets.end() - 1);
+  for (const std::pair<int, int> &pair : pairs){
+    ids[cursor[pair.first]++] = pair.second;
+    ids[cursor[pair.second]++] = pair.first;
+  }
+
+  // Ascending candidates, the rows are written in memory order
+  for (int i = 0; i < num_agents; i++){
+    std::sort(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]);
+  }
+}
+
+// Explicit instantiation
+template class NeighborLists<float>;
+template class NeighborLists<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,114 @@
+#ifndef NEIGHBORLISTS_H
+#define NEIGHBORLISTS_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "Point3D.h"
+#include "State.h"
+#include "AgentData.h"
+#include "helpers.h"
+
+// Cells of the build grid per agent at most
+#define NEIGHBOR_CELLS_PER_AGENT 4
+
+/*
+ * Verlet lists of the agent pairs which can perceive each other. The
+ * radius of an agent is the largest of its audibility threshold,
+ * movespeed and size, every predicate of the agent to agent masks is
+ * false beyond the larger radius of a pair. The candidates of an agent
+ * are the agents closer than the larger radius plus the skin at the
+ * last build. In a periodic world the distances are the ones of the
+ * closest images and the grid wraps around the world. Dead agents and
+ * free slots are left out, they have no candidates and are none.
+ *
+ * The lists stay valid as long as no agent became active, no radius
+ * grew and no two agents together moved by the skin since the build,
+ * update only rebuilds them then. A build sorts the agents into a
+ * uniform grid and scans the cells within the radius plus skin of each
+ * agent.
+ */
+template <typename T>
+class NeighborLists
+{
+ public:
+
+  // Constructor
+  NeighborLists();
+
+  // Destructor
+  ~NeighborLists();
+
+  // Set the skin and the half sizes of a periodic world, NULL if the
+  // world is not periodic, invalidates the lists
+  void init(T skin, const T *box);
+
+  // Invalidate the lists, the next update rebuilds them
+  void invalidate();
+
+  // Rebuild the lists if they are not valid for the state, returns
+  // true if they were rebuilt
+  bool update(const State<T> &state);
+
+  // Candidates of agent i in ascending order
+  const int *begin(int i) const { return ids.data() + offsets[i]; }
+  const int *end(int i) const { return ids.data() + offsets[i + 1]; }
+
+  // Number of builds since init
+  int getNumBuilds() const;
+
+  // Number of candidates of all agents
+  int getNumCandidates() const;
+
+ private:
+
+  // Radius of agent i
+  T static radius(const State<T> &state, int i)
+  {
+    return std::max(state.audibility_threshold[i],
+        std::max(state.movespeed[i], state.sizes[i]));
+  }
+
+  // Test if the lists are valid for the state
+  bool isValid(const State<T> &state) const;
+
+  // Build the lists of the state
+  void build(const State<T> &state);
+
+  // Skin added to the radii
+  T skin;
+
+  // Periodic world of half sizes box, its periods and their inverses,
+  // see Point3D::periods
+  bool periodic;
+  T box[3];
+  Point3D<T> period;
+  Point3D<T> inv_period;
+
+  // The lists are built
+  bool valid;
+
+  // Number of builds
+  int num_builds;
+
+  // Positions, radii and active flags of the agents at the last build
+  std::vector<Point3D<T>> positions;
+  std::vector<T> radii;
+  std::vector<char> active;
+
+  // Candidates of agent i are ids[offsets[i]] to ids[offsets[i+1]-1]
+  std::vector<int> offsets;
+  std::vector<int> ids;
+
+  // Agents of cell c are cell_agents[cell_start[c]] to
+  // cell_agents[cell_start[c+1]-1]
+  std::vector<int> cell_start;
+  std::vector<int> cell_agents;
+
+  // Pairs found during a build
+  std::vector<std::pair<int, int>> pairs;
+};
+
+#endif // NEIGHBORLISTS_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -95,9 +95,91 @@ struct Point3D
     { return (x-p.x)*(x-p.x) + (y-p.y)*(y-p.y) + (z-p.z)*(z-p.z); }
 
     // Return the distance between two points
-    inline T distance(const Point3D<T> &p) 
+    inline T distance(const Point3D<T> &p) const
     { return sqrt((x-p.x)*(x-p.x) + (y-p.y)*(y-p.y) + (z-p.z)*(z-p.z)); }
 
+    // Sizes of a periodic world of half sizes box and their inverses,
+    // the inverse is 0 along an axis without extent; the minimum image
+    // of the kernels, the neighbor lists and the agents all derive from
+    // these, so that they agree at exactly half a period
+    inline static void periods(const T *box, Point3D<T> &period,
+        Point3D<T> &inv_period)
+    {
+      period = Point3D<T>(2*box[0], 2*box[1], 2*box[2]);
+      inv_period = Point3D<T>(
+          box[0] > 0.0 ? (T)1.0/period.x : (T)0.0,
+          box[1] > 0.0 ? (T)1.0/period.y : (T)0.0,
+          box[2] > 0.0 ? (T)1.0/period.z : (T)0.0);
+    }
+
+    // Period to subtract from the difference d of two coordinates for 
+    // the closest image without branches, period is the size of the 
+    // world along the axis and inv_period its inverse, see periods
+    inline static T wrapShift(T d, T period, T inv_period)
+    { return period*std::nearbyint(d*inv_period); }
+
+    // Closest image of the difference d of two coordinates
+    inline static T wrapDifference(T d, T period, T inv_period)
+    { return d - wrapShift(d, period, inv_period); }
+
+    // Return the distance between two points in a periodic world
+    // without branches, the loops of the distance kernels vectorize
+    inline T distance(const Point3D<T> &p, const Point3D<T> &period,
+        const Point3D<T> &inv_period) const
+    {
+      T dx = wrapDifference(x-p.x, period.x, inv_period.x);
+      T dy = wrapDifference(y-p.y, period.y, inv_period.y);
+      T dz = wrapDifference(z-p.z, period.z, inv_period.z);
+      return sqrt(dx*dx + dy*dy + dz*dz);
+    }
+
+    // Return the distance between two points in a periodic world, box
+    // holds the half sizes of the world, the closest image is taken
+    inline T distance(const Point3D<T> &p, const T *box) const
+    { 
+      Point3D<T> period, inv_period;
+      periods(box, period, inv_period);
+      return distance(p, period, inv_period);
+    }
+
+    // Return the image of p closest to this point in a periodic world of
+    // the given periods, see periods
+    inline Point3D image(const Point3D<T> &p, const Point3D<T> &period,
+        const Point3D<T> &inv_period) const
+    {
+      return Point3D(p.x - wrapShift(p.x-x, period.x, inv_period.x), 
+          p.y - wrapShift(p.y-y, period.y, inv_period.y), 
+          p.z - wrapShift(p.z-z, period.z, inv_period.z));
+    }
+
+    // Return the image of p closest to this point in a periodic world,
+    // box holds the half sizes of the world, p itself if box is NULL
+    inline Point3D image(const Point3D<T> &p, const T *box) const
+    {
+      if (box == NULL) {
+        return p;
+      }
+      Point3D<T> period, inv_period;
+      periods(box, period, inv_period);
+      return image(p, period, inv_period);
+    }
+
+    // Map this point into a periodic world of half sizes box, whole
+    // periods are subtracted, a move can be longer than the world, an
+    // axis without extent has no period and the point is kept on its
+    // plane
+    inline void wrapInto(const T *box)
+    {
+      for (int i = 0; i < 3; i++){
+        if (box[i] <= 0.0){
+          (*this)[i] = 0.0;
+        } else if ((*this)[i] > box[i] || (*this)[i] < -box[i]){
+          T period = 2 * box[i];
+          (*this)[i] -= period * std::floor(((*this)[i] + box[i]) / period);
+        }
+      }
+    }
+
     // Return the direction from this point to another point
     inline Point3D direction(const Point3D<T> &p) 
     { return Point3D(p.x-x, p.y-y, p.z-z); }
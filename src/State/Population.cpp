@@ -0,0 +1,143 @@
+#include "Population.h"
+#include "AgentData.h"
+
+template <typename T>
+Population<T>::Population()
+  : dynamic(false)
+{
+#ifdef DEBUG
+  std::cout << "Population::Population: Constructor" << std::endl;
+#endif
+}
+
+template <typename T>
+Population<T>::~Population()
+{
+#ifdef DEBUG
+  std::cout << "Population::~Population: Destructor" << std::endl;
+#endif
+}
+
+template <typename T>
+void Population<T>::init(const SimulationParameters<T> &sim_params,
+    const State<T> &state)
+{
+  classes.clear();
+  dynamic = false;
+  for (const AgentClassParameters<T> &c : sim_params.agent_class_params){
+    Slots slots;
+    slots.start = c.start_index;
+    slots.stop = c.stop_index;
+    for (int i = c.start_index; i < c.stop_index; i++){
+      if (state.status[i] == (int)Status::VACANT){
+        slots.free.push_back(i);
+      }
+    }
+    std::make_heap(slots.free.begin(), slots.free.end(), std::greater<int>());
+    classes.push_back(slots);
+
+    // Without free slots, births and deaths without respawn the classes
+    // keep their agents
+    dynamic = dynamic || !slots.free.empty() || !c.respawn
+      || c.reproduction_energy > 0.0;
+  }
+
+#ifdef DEBUG
+  std::cout << "Population::init: \
+    Classes " << classes.size() << ", dynamic " << dynamic << std::endl;
+#endif
+}
+
+template <typename T>
+bool Population<T>::isDynamic() const
+{
+  return dynamic;
+}
+
+template <typename T>
+void Population<T>::update(const State<T> &state, const State<T> &new_state)
+{
+  for (int c = 0; c < (int)classes.size(); c++){
+    for (int i = classes[c].start; i < classes[c].stop; i++){
+      if (new_state.status[i] == (int)Status::VACANT
+          && state.status[i] != (int)Status::VACANT){
+        release(c, i);
+      }
+    }
+  }
+}
+
+template <typename T>
+int Population<T>::acquire(int class_id)
+{
+  std::vector<int> &free = classes[class_id].free;
+  if (free.empty()){
+    return -1;
+  }
+  std::pop_heap(free.begin(), free.end(), std::greater<int>());
+  const int id = free.back();
+  free.pop_back();
+  return id;
+}
+
+template <typename T>
+void Population<T>::release(int class_id, int id)
+{
+  std::vector<int> &free = classes[class_id].free;
+  free.push_back(id);
+  std::push_heap(free.begin(), free.end(), std::greater<int>());
+}
+
+template <typename T>
+int Population<T>::getNumAgents(int class_id) const
+{
+  const Slots &slots = classes[class_id];
+  return slots.stop - slots.start - (int)slots.free.size();
+}
+
+template <typename T>
+int Population<T>::getNumFree(int class_id) const
+{
+  return (int)classes[class_id].free.size();
+}
+
+template <typename T>
+void Population<T>::compact(State<T> &state,
+    std::vector<std::pair<int, int>> &moves)
+{
+  moves.clear();
+  for (int c = 0; c < (int)classes.size(); c++){
+    Slots &slots = classes[c];
+
+    // Move the last agent into the lowest free slot until no free slot
+    // is left below an agent
+    int last = slots.stop - 1;
+    while (!slots.free.empty()){
+      while (last >= slots.start
+          && state.status[last] == (int)Status::VACANT){
+        last--;
+      }
+      if (slots.free.front() > last){
+        break;
+      }
+      const int id = acquire(c);
+      state.copyAgent(last, id);
+      state.status[last] = (int)Status::VACANT;
+      state.energy[last] = 0.0;
+      release(c, last);
+      moves.push_back(std::make_pair(last, id));
+      last--;
+    }
+  }
+
+#ifdef DEBUG
+  std::cout << "Population::compact: \
+    Moved " << moves.size() << " agents" << std::endl;
+#endif
+}
+
+// Explicit instantiation
+template class Population<float>;
+template class Population<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,84 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "State.h"
+#include "SimulationParameters.h"
+#include "helpers.h"
+
+// Steps between two compactions of the classes
+#define POPULATION_COMPACT_INTERVAL 64
+
+/*
+ * Slots of the agents of all classes. Every class holds the contiguous
+ * slots start_index to stop_index-1 of the state, as many as its largest
+ * number of agents, the slots without an agent have the status VACANT.
+ * An agent of a class which does not respawn frees its slot when it
+ * dies, a birth takes the lowest free slot of its class. The arrays of
+ * the state and the derived quantities keep their size, the kernels
+ * skip the free slots like dead agents.
+ *
+ * Births fill the holes from the front, compact moves the last agents
+ * of a class into the holes left below them, so the agents of a class
+ * stay at the front of its slots.
+ */
+template <typename T>
+class Population
+{
+ public:
+
+  // Constructor
+  Population();
+
+  // Destructor
+  ~Population();
+
+  // Collect the free slots of the classes of the state
+  void init(const SimulationParameters<T> &sim_params,
+      const State<T> &state);
+
+  // Test if the number of agents of any class can change
+  bool isDynamic() const;
+
+  // Free the slots which the transition from state to new_state left
+  // VACANT
+  void update(const State<T> &state, const State<T> &new_state);
+
+  // Take the lowest free slot of a class, -1 if the class is full
+  int acquire(int class_id);
+
+  // Return the slot id of a class
+  void release(int class_id, int id);
+
+  // Number of agents of a class
+  int getNumAgents(int class_id) const;
+
+  // Number of free slots of a class
+  int getNumFree(int class_id) const;
+
+  // Move the last agents of every class into the free slots below
+  // them, moves holds the pairs of the old and the new slot
+  void compact(State<T> &state, std::vector<std::pair<int, int>> &moves);
+
+ private:
+
+  // Slots start to stop-1 of a class, free holds the free slots as a
+  // heap with the lowest on top
+  struct Slots
+  {
+    int start;
+    int stop;
+    std::vector<int> free;
+  };
+
+  std::vector<Slots> classes;
+
+  // Number of agents of any class can change
+  bool dynamic;
+};
+
+#endif // POPULATION_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
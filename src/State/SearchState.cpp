@@ -0,0 +1,403 @@
+#include "SearchState.h"
+#include "asa241.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+template <typename T>
+SearchState<T>::SearchState(
+    std::mt19937 &gen,
+    std::uniform_real_distribution<T> &dist_uni,
+    std::uniform_real_distribution<T> &dist_x,
+    std::uniform_real_distribution<T> &dist_y,
+    std::uniform_real_distribution<T> &dist_z)
+  : gen(gen), dist_uni(dist_uni),
+  dist_x(dist_x), dist_y(dist_y), dist_z(dist_z),
+  num_agents(0), worldsize{0.0, 0.0, 0.0}, periodic(false)
+{
+#ifdef DEBUG
+  std::cout << "SearchState::SearchState: Constructor" << std::endl;
+#endif
+}
+
+template <typename T>
+SearchState<T>::~SearchState()
+{
+#ifdef DEBUG
+  std::cout << "SearchState::~SearchState: Destructor" << std::endl;
+#endif
+}
+
+template <typename T>
+void SearchState<T>::init(int num_agents,
+    SimulationParameters<T> &sim_params)
+{
+#ifdef DEBUG
+  std::cout << "SearchState::init: \
+    Initializing the search memory of " << num_agents << " agents"
+    << std::endl;
+#endif
+
+  // Set the number of agents
+  this->num_agents = num_agents;
+
+  // Copy the world size
+  sim_params.getWorldsize(worldsize);
+  periodic = sim_params.getPeriodic();
+
+  // Search parameters of the classes
+  int num_classes = (int)sim_params.agent_class_params.size();
+  mu_levy.resize(num_classes);
+  c_levy.resize(num_classes);
+  brownian_search_duration.resize(num_classes);
+  for (int c = 0; c < num_classes; c++){
+    mu_levy[c] = sim_params.agent_class_params[c].getMuLevy();
+    c_levy[c] = sim_params.agent_class_params[c].getCLevy();
+    brownian_search_duration[c] =
+      sim_params.agent_class_params[c].getBrownianSearchDuration();
+  }
+
+  // Search memory of the agents, set by reset
+  class_id.assign(num_agents, 0);
+  search_type.assign(num_agents, SearchType::NUM_SEARCH_TYPES);
+  target_x.assign(num_agents, 0.0);
+  target_y.assign(num_agents, 0.0);
+  target_z.assign(num_agents, 0.0);
+  brownian_start.assign(num_agents, 0.0);
+  brownian_duration.assign(num_agents, 0.0);
+  finished.assign(num_agents, 0);
+  direction_x.assign(num_agents, 0.0);
+  direction_y.assign(num_agents, 0.0);
+  direction_z.assign(num_agents, 0.0);
+  brownian_x.assign(num_agents, 0.0);
+  brownian_y.assign(num_agents, 0.0);
+  brownian_z.assign(num_agents, 0.0);
+}
+
+template <typename T>
+void SearchState<T>::reset(int id, int class_id)
+{
+#ifdef DEBUG
+  /*
+  std::cout << "SearchState::reset: \
+    Resetting the search of agent " << id << std::endl;
+    */
+#endif
+  this->class_id[id] = class_id;
+  brownian_duration[id] = brownian_search_duration[class_id];
+  brownian_start[id] = 0.0;
+  finished[id] = 0;
+
+  // Set random target
+  drawTarget(id);
+
+  // Agents with a brownian search start with one in their first step,
+  // the others head for the random target
+  if (brownian_duration[id] > 0.0){
+    search_type[id] = SearchType::NUM_SEARCH_TYPES;
+  }else{
+    search_type[id] = SearchType::LEVY;
+  }
+}
+
+template <typename T>
+void SearchState<T>::copyAgent(int from, int to)
+{
+  // The directions are recalculated in the next update
+  class_id[to] = class_id[from];
+  search_type[to] = search_type[from];
+  target_x[to] = target_x[from];
+  target_y[to] = target_y[from];
+  target_z[to] = target_z[from];
+  brownian_start[to] = brownian_start[from];
+  brownian_duration[to] = brownian_duration[from];
+  finished[to] = finished[from];
+}
+
+template <typename T>
+void SearchState<T>::update(const State<T> &state, uint64_t key)
+{
+#ifdef DEBUG
+  std::cout << "SearchState::update: \
+    Updating the search memory of the agents" << std::endl;
+#endif
+
+  // Draw the brownian directions of this step in one batch
+  fillDirections(key, state.iteration, num_agents,
+      brownian_x.data(), brownian_y.data(), brownian_z.data());
+
+  // Test which searches are finished and get the directions of the
+  // ongoing ones, this only reads the state and the search memory
+  const double timestamp = state.getTimestamp();
+  for (int i = 0; i < num_agents; i++){
+    if (search_type[i] == SearchType::LEVY){
+      Point3D<T> target = targetImage(state, i);
+      finished[i] = state.positions[i].distance(target) < state.movespeed[i];
+      if (!finished[i]){
+        Point3D<T> d = state.positions[i].normalizedDirection(target);
+        direction_x[i] = d.x;
+        direction_y[i] = d.y;
+        direction_z[i] = d.z;
+      }
+    }else if (search_type[i] == SearchType::BROWNIAN){
+      T time_passed = timestamp - brownian_start[i];
+      finished[i] = time_passed > brownian_duration[i];
+      direction_x[i] = brownian_x[i];
+      direction_y[i] = brownian_y[i];
+      direction_z[i] = brownian_z[i];
+    }else{
+      finished[i] = 0;
+    }
+  }
+}
+
+template <typename T>
+Point3D<T> SearchState<T>::getDirection(const State<T> &state, int id)
+{
+#ifdef DEBUG
+  /*
+  std::cout << "SearchState::getDirection: \
+    Getting the search direction of agent " << id << std::endl;
+    */
+#endif
+  bool changed = false;
+
+  // In the first search, the agent starts with a brownian search
+  if (search_type[id] == SearchType::NUM_SEARCH_TYPES){
+    if (brownian_duration[id] > 0.0){
+      search_type[id] = SearchType::BROWNIAN;
+      startBrownianSearch(state, id);
+    }else{
+      search_type[id] = SearchType::LEVY;
+      startLevySearch(state, id);
+    }
+    finished[id] = isFinished(state, id);
+    changed = true;
+  }
+
+  // Switch to the next search if the current one is finished
+  if (finished[id]){
+    if (search_type[id] == SearchType::LEVY){
+      if (brownian_duration[id] > 0.0){
+        search_type[id] = SearchType::BROWNIAN;
+        startBrownianSearch(state, id);
+      }else{
+        startLevySearch(state, id);
+      }
+    }else if (search_type[id] == SearchType::BROWNIAN){
+      search_type[id] = SearchType::LEVY;
+      startLevySearch(state, id);
+    }else{
+      handleError("SearchState::getDirection: Unsupported search type",
+          CRITICAL);
+    }
+    finished[id] = 0;
+    changed = true;
+  }
+
+  // The precomputed direction is outdated if the search changed
+  if (changed){
+    return searchDirection(state, id);
+  }
+  return Point3D<T>(direction_x[id], direction_y[id], direction_z[id]);
+}
+
+template <typename T>
+void SearchState<T>::startLevySearch(const State<T> &state, int id)
+{
+  // Draw a random target
+  drawTarget(id);
+
+  // Calculate the direction to the target
+  Point3D<T> &current_position = state.positions[id];
+  Point3D<T> target = targetImage(state, id);
+  Point3D<T> direction = current_position.normalizedDirection(target);
+
+  // Scale the direction by a random number from the Levy distribution
+  direction *= levyRand(class_id[id]);
+
+  // Recalculate the target, stay if it is outside the world, a flight
+  // in a periodic world continues on the other side
+  target = current_position + direction;
+  if (periodic){
+    target.wrapInto(worldsize);
+  } else if (!isWithinWorld(target)){
+#ifdef DEBUG
+    /*
+    std::cout << "SearchState::startLevySearch: \
+      Target is outside the world" << std::endl;
+      */
+#endif
+    target = current_position;
+  }
+  target_x[id] = target.x;
+  target_y[id] = target.y;
+  target_z[id] = target.z;
+}
+
+template <typename T>
+void SearchState<T>::startBrownianSearch(const State<T> &state, int id)
+{
+  // Set the start time of the search
+  brownian_start[id] = state.getTimestamp();
+}
+
+template <typename T>
+bool SearchState<T>::isFinished(const State<T> &state, int id) const
+{
+  if (search_type[id] == SearchType::LEVY){
+    // Check if the target is in reach
+    Point3D<T> target = targetImage(state, id);
+    return state.positions[id].distance(target) < state.movespeed[id];
+  }
+
+  // Check if the search duration has passed
+  T time_passed = state.getTimestamp() - brownian_start[id];
+  return time_passed > brownian_duration[id];
+}
+
+template <typename T>
+Point3D<T> SearchState<T>::searchDirection(const State<T> &state,
+    int id) const
+{
+  if (search_type[id] == SearchType::LEVY){
+    Point3D<T> target = targetImage(state, id);
+    return state.positions[id].normalizedDirection(target);
+  }
+  return Point3D<T>(brownian_x[id], brownian_y[id], brownian_z[id]);
+}
+
+// Tabulated quantile of the half normal distribution, z(p) =
+// Phi^-1(1 - p/2), values and slopes on a uniform grid of p in
+// [LEVY_TABLE_MIN, 1], cubic Hermite interpolation in between, the
+// logarithmic tail below LEVY_TABLE_MIN is left to AS241
+#define LEVY_TABLE_SIZE 4096
+#define LEVY_TABLE_MIN (1.0 / 64.0)
+
+template <typename T>
+struct HalfNormalQuantileTable
+{
+  T z[LEVY_TABLE_SIZE + 1];
+  T dz[LEVY_TABLE_SIZE + 1];
+
+  HalfNormalQuantileTable()
+  {
+    const double h = (1.0 - LEVY_TABLE_MIN) / LEVY_TABLE_SIZE;
+    const double inv_sqrt_2pi = 0.3989422804014327;
+    for (int i = 0; i <= LEVY_TABLE_SIZE; i++){
+      double p = LEVY_TABLE_MIN + i * h;
+      double zi = r8_normal_01_cdf_inverse(1.0 - 0.5 * p);
+      // dz/dp = -1 / (2 phi(z)), scaled to the grid spacing
+      double phi = inv_sqrt_2pi * std::exp(-0.5 * zi * zi);
+      z[i] = (T)zi;
+      dz[i] = (T)(-0.5 * h / phi);
+    }
+  }
+};
+
+template <typename T>
+static T halfNormalQuantile(T p)
+{
+  if (p < (T)LEVY_TABLE_MIN){
+    if constexpr (std::is_same<T, float>::value){
+      return r4_normal_01_cdf_inverse(1.0f - 0.5f*p);
+    } else {
+      return r8_normal_01_cdf_inverse(1.0 - 0.5*p);
+    }
+  }
+
+  // Built once, on first use
+  static const HalfNormalQuantileTable<T> table;
+  T x = (p - (T)LEVY_TABLE_MIN)
+    * (T)(LEVY_TABLE_SIZE / (1.0 - LEVY_TABLE_MIN));
+  int i = std::min((int)x, LEVY_TABLE_SIZE - 1);
+  T t = x - (T)i;
+  T t2 = t * t;
+  T t3 = t2 * t;
+  return (2*t3 - 3*t2 + 1) * table.z[i] + (t3 - 2*t2 + t) * table.dz[i]
+    + (3*t2 - 2*t3) * table.z[i + 1] + (t3 - t2) * table.dz[i + 1];
+}
+
+template <typename T>
+T SearchState<T>::levyRand(int class_id)
+{
+  // see: https://en.wikipedia.org/wiki/L%C3%A9vy_distribution#Random-sample_generation
+  // Draw a random number from a Levy distribution
+  T p = dist_uni(gen);
+  T z = halfNormalQuantile(p);
+  return mu_levy[class_id] + c_levy[class_id] / (z * z);
+}
+
+template <typename T>
+void SearchState<T>::drawTarget(int id)
+{
+  // Draw a random target
+  target_x[id] = dist_x(gen);
+  target_y[id] = dist_y(gen);
+  target_z[id] = dist_z(gen);
+}
+
+template <typename T>
+bool SearchState<T>::isWithinWorld(const Point3D<T> &point) const
+{
+  // Check if the point is inside the world
+  if (point.x < -worldsize[0] || point.x > worldsize[0]) return false;
+  if (point.y < -worldsize[1] || point.y > worldsize[1]) return false;
+  if (point.z < -worldsize[2] || point.z > worldsize[2]) return false;
+
+  return true;
+}
+
+template <typename T>
+Point3D<T> SearchState<T>::targetImage(const State<T> &state, int id) const
+{
+  Point3D<T> target(target_x[id], target_y[id], target_z[id]);
+  return state.positions[id].image(target, periodic ? worldsize : NULL);
+}
+
+// Splitmix64 finalizer, maps a counter to 64 random bits
+static inline uint64_t mixBits(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+template <typename T>
+void SearchState<T>::fillDirections(uint64_t key, int step,
+    int num_agents, T *x, T *y, T *z)
+{
+  const uint64_t step_key = mixBits(key ^ ((uint64_t)(uint32_t)step << 32));
+  const T scale = (T)(1.0 / 4294967296.0);
+  const T two_pi = (T)6.283185307179586;
+
+  // Uniform on the unit sphere: z uniform in [-1, 1],
+  // azimuth uniform in [0, 2 pi), x holds the radius of the circle at z
+  // and y the azimuth until the second loop
+#pragma omp simd
+  for (int i = 0; i < num_agents; i++){
+    uint64_t bits = mixBits(step_key + (uint64_t)i);
+    T zi = (T)1.0 - (T)2.0 * (T)(uint32_t)(bits >> 32) * scale;
+    x[i] = std::sqrt(std::max((T)0.0, (T)1.0 - zi * zi));
+    y[i] = two_pi * (T)(uint32_t)(bits & 0xffffffffULL) * scale;
+    z[i] = zi;
+  }
+
+  // Without a vector math library the sine and cosine stay scalar calls
+  for (int i = 0; i < num_agents; i++){
+    T r = x[i];
+    T phi = y[i];
+    x[i] = r * std::cos(phi);
+    y[i] = r * std::sin(phi);
+  }
+}
+
+// Explicit instantiation
+template class SearchState<float>;
+template class SearchState<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,158 @@
+#ifndef SEARCHSTATE_H
+#define SEARCHSTATE_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Point3D.h"
+#include "State.h"
+#include "SimulationParameters.h"
+#include "helpers.h"
+
+enum SearchType
+{
+  LEVY,
+  BROWNIAN,
+  NUM_SEARCH_TYPES
+};
+
+/*
+ * Search memory of all agents as a structure of arrays, indexed by the
+ * agent id. An agent alternates between a Levy flight to a random target
+ * and a Brownian search of fixed duration, if the Brownian search
+ * duration of its class is zero, it only performs Levy flights.
+ *
+ * Per step, update runs over all agents: it draws the Brownian
+ * directions, tests which Levy targets are reached and which Brownian
+ * searches are over and precomputes the Levy directions. getDirection
+ * then only switches the search of the agents which are finished, these
+ * draw from the shared random number generator in the order of the moves.
+ */
+template <typename T>
+class SearchState
+{
+
+ public:
+
+  // Constructor
+  SearchState(
+      std::mt19937 &gen,
+      std::uniform_real_distribution<T> &dist_uni,
+      std::uniform_real_distribution<T> &dist_x,
+      std::uniform_real_distribution<T> &dist_y,
+      std::uniform_real_distribution<T> &dist_z);
+
+  // Destructor
+  ~SearchState();
+
+  // Allocate the search memory of num_agents agents and read the
+  // search parameters of the classes
+  void init(int num_agents, SimulationParameters<T> &sim_params);
+
+  // Start over the search of an agent, e.g. after a respawn
+  void reset(int id, int class_id);
+
+  // Continue the search of agent from in the slot to, e.g. after the
+  // agent moved there in a compaction
+  void copyAgent(int from, int to);
+
+  // Prepare the search of all agents for the step of the state, the
+  // brownian directions are drawn from a counter based generator with
+  // the given key
+  void update(const State<T> &state, uint64_t key);
+
+  // Get the search direction of an agent, switches to the next search
+  // if the current one is finished, returns a normalized direction
+  // vector of lenght 1
+  Point3D<T> getDirection(const State<T> &state, int id);
+
+  // Draw the brownian directions of a step for num_agents agents,
+  // uniformly distributed on the unit sphere
+  static void fillDirections(uint64_t key, int step, int num_agents,
+      T *x, T *y, T *z);
+
+ private:
+
+  // Random number generator
+  std::mt19937 &gen;
+
+  // Uniform distributions
+  std::uniform_real_distribution<T> &dist_uni;
+  std::uniform_real_distribution<T> &dist_x;
+  std::uniform_real_distribution<T> &dist_y;
+  std::uniform_real_distribution<T> &dist_z;
+
+  // Number of agents
+  int num_agents;
+
+  // Worldsize
+  T worldsize[3];
+
+  // Periodic world, the targets are taken at their closest image
+  bool periodic;
+
+  // Parameters of the Levy distribution and brownian search duration,
+  // indexed by the class id
+  std::vector<T> mu_levy;
+  std::vector<T> c_levy;
+  std::vector<T> brownian_search_duration;
+
+  // Class of the agents
+  std::vector<int> class_id;
+
+  // Search type of the agents, NUM_SEARCH_TYPES before the first search
+  std::vector<int> search_type;
+
+  // Levy targets
+  std::vector<T> target_x;
+  std::vector<T> target_y;
+  std::vector<T> target_z;
+
+  // Start time and duration of the brownian searches
+  std::vector<T> brownian_start;
+  std::vector<T> brownian_duration;
+
+  // Search finished in the current step
+  std::vector<char> finished;
+
+  // Directions of the current step, towards the Levy target or
+  // the brownian direction
+  std::vector<T> direction_x;
+  std::vector<T> direction_y;
+  std::vector<T> direction_z;
+
+  // Brownian directions of the current step
+  std::vector<T> brownian_x;
+  std::vector<T> brownian_y;
+  std::vector<T> brownian_z;
+
+
+  /* Private methods */
+
+  // Start a Levy flight from the current position
+  void startLevySearch(const State<T> &state, int id);
+
+  // Start a brownian search at the current time
+  void startBrownianSearch(const State<T> &state, int id);
+
+  // Test if the search of an agent is finished
+  bool isFinished(const State<T> &state, int id) const;
+
+  // Direction of the current search of an agent
+  Point3D<T> searchDirection(const State<T> &state, int id) const;
+
+  // Draw a random number from the Levy distribution of a class
+  T levyRand(int class_id);
+
+  // Draw a random target in the world
+  void drawTarget(int id);
+
+  // Test if a point is within the world
+  bool isWithinWorld(const Point3D<T> &point) const;
+
+  // Levy target of an agent, its closest image in a periodic world
+  Point3D<T> targetImage(const State<T> &state, int id) const;
+};
+
+#endif // SEARCHSTATE_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
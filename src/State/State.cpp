@@ -2,37 +2,41 @@
 
 template <typename T>
 State<T>::State()
-  : num_agents_total(0),
+  : arena(NULL),
+  arena_size(0),
   verbosity(0),
+  num_agents_total(0),
   num_classes(0),
+  pitch(0),
+  mask_pitch(0),
   iteration(0),
   run_counter(0),
   time(0),
+  initialized(false),
   positions(NULL),
   energy(NULL),
-  energy_consumption_per_distance(NULL),
-  energy_consumption_per_time(NULL),
-  energy_uptake_rate(NULL),
   movespeed(NULL),
   sizes(NULL),
   status(NULL),
   class_id(NULL),
   strategy(NULL),
+  audibility_threshold(NULL),
+  energy_consumption_per_time(NULL),
+  energy_consumption_per_distance(NULL),
+  energy_uptake_rate(NULL),
   distances_agent_to_agent(NULL),
   distances_agent_to_class(NULL),
   distances_class_to_class(NULL),
   audibility(NULL),
   audibility_agent_to_class(NULL),
   audibility_class_to_class(NULL),
-  audibility_threshold(NULL),
   reachability(NULL),
   reachability_agent_to_class(NULL),
   reachability_class_to_class(NULL),
   contact(NULL),
   contact_agent_to_class(NULL),
   contact_class_to_class(NULL),
-  initialized(false)
-
+  hears_food(NULL)
 {
 #ifdef DEBUG
   std::cout << "State::State: \
@@ -43,12 +47,16 @@ State<T>::State()
 
 template <typename T>
 State<T>::State(const State& other)
-  : num_agents_total(other.num_agents_total),
+  : arena(NULL),
+  arena_size(0),
+  verbosity(other.verbosity),
+  num_agents_total(other.num_agents_total),
+  num_classes(other.num_classes),
+  pitch(other.pitch),
+  mask_pitch(other.mask_pitch),
   iteration(other.iteration),
   run_counter(other.run_counter),
-  num_classes(other.num_classes),
   time(other.time),
-  verbosity(other.verbosity),
   initialized(other.initialized)
 {
 #ifdef DEBUG
@@ -56,39 +64,29 @@ State<T>::State(const State& other)
     Copy constructor of State" << std::endl;
 #endif
 
-  // Copy pointers and data
-  positions = other.positions;
-  energy = other.energy;
-  energy_consumption_per_distance = other.energy_consumption_per_distance;
-  energy_consumption_per_time = other.energy_consumption_per_time;
-  energy_uptake_rate = other.energy_uptake_rate;
-  movespeed = other.movespeed;
-  sizes = other.sizes;
-  status = other.status;
-  class_id = other.class_id;
-  strategy = other.strategy;
-
-  distances_agent_to_agent = other.distances_agent_to_agent;
-  distances_agent_to_class = other.distances_agent_to_class;
-  distances_class_to_class = other.distances_class_to_class;
-
-  audibility_threshold = other.audibility_threshold;
-  audibility = other.audibility;
-  audibility_agent_to_class = other.audibility_agent_to_class;
-  audibility_class_to_class = other.audibility_class_to_class;
-
-  reachability = other.reachability;
-  reachability_agent_to_class = other.reachability_agent_to_class;
-  reachability_class_to_class = other.reachability_class_to_class;
-
-  contact = other.contact;
-  contact_agent_to_class = other.contact_agent_to_class;
-  contact_class_to_class = other.contact_class_to_class;
+  // Copy pointers, the arena is shared with other
+  clearPointers();
+  arena = other.arena;
+  arena_size = other.arena_size;
+  if (arena != NULL){
+    layoutArena(num_agents_total, num_classes, arena);
+  }
 }
 
 
 template <typename T>
 State<T>::State(State&& other)
+  : arena(NULL),
+  arena_size(0),
+  verbosity(0),
+  num_agents_total(0),
+  num_classes(0),
+  pitch(0),
+  mask_pitch(0),
+  iteration(0),
+  run_counter(0),
+  time(0),
+  initialized(false)
 {
 #ifdef DEBUG
   std::cout << "State::State: \
@@ -96,114 +94,26 @@ State<T>::State(State&& other)
 #endif
   // Moves resources from other to this
   // Leaves other in a valid but unspecified state
-  
-  // Free memory
-  bool other_initialized = other.initialized;
-  int other_num_agents = other.num_agents_total;
-  int other_num_classes = other.num_classes;
-  int other_iteration = other.iteration;
-  int other_run_counter = other.run_counter;
-  int other_verbosity = other.verbosity;
-  double other_time = other.time;
-  other.time = 0;
-  other.initialized = false;
-  other.num_agents_total = 0;
-  other.num_classes = 0;
-  other.iteration = 0;
-  other.run_counter = 0;
-  other.verbosity = 0;
-  this->initialized = false;
-  this->num_agents_total = 0;
-  this->num_classes = 0;
-  this->iteration = 0;
-  this->run_counter = 0;
-  this->time = 0;
-  freeMemory();
-
-  // Move pointers
-  positions = other.positions;
-  energy = other.energy;
-  energy_consumption_per_distance = other.energy_consumption_per_distance;
-  energy_consumption_per_time = other.energy_consumption_per_time;
-  energy_uptake_rate = other.energy_uptake_rate;
-  movespeed = other.movespeed;
-  sizes = other.sizes;
-  status = other.status;
-  class_id = other.class_id;
-  strategy = other.strategy;
-
-  distances_agent_to_agent = other.distances_agent_to_agent;
-  distances_agent_to_class = other.distances_agent_to_class;
-  distances_class_to_class = other.distances_class_to_class;
-
-  audibility = other.audibility;
-  audibility_agent_to_class = other.audibility_agent_to_class;
-  audibility_class_to_class = other.audibility_class_to_class;
-  audibility_threshold = other.audibility_threshold;
-
-  reachability = other.reachability;
-  reachability_agent_to_class = other.reachability_agent_to_class;
-  reachability_class_to_class = other.reachability_class_to_class;
-
-  contact = other.contact;
-  contact_agent_to_class = other.contact_agent_to_class;
-  contact_class_to_class = other.contact_class_to_class;
-
-
-  // Reset other
-  other.positions = NULL;
-  other.energy = NULL;
-  other.energy_consumption_per_distance = NULL;
-  other.energy_consumption_per_time = NULL;
-  other.energy_uptake_rate = NULL;
-  other.movespeed = NULL;
-  other.sizes = NULL;
-  other.status = NULL;
-  other.class_id = NULL;
-  other.strategy = NULL;
-
-  other.distances_agent_to_agent = NULL;
-other.distances_agent_to_class = NULL;
-  other.distances_class_to_class = NULL;
-
-  other.audibility = NULL;
-  other.audibility_agent_to_class = NULL;
-  other.audibility_class_to_class = NULL;
-  other.audibility_threshold = NULL;
-
-  other.reachability = NULL;
-  other.reachability_agent_to_class = NULL;
-  other.reachability_class_to_class = NULL;
-
-  other.contact = NULL;
-  other.contact_agent_to_class = NULL;
-  other.contact_class_to_class = NULL;
-
-  // Set initialized flag and member variables
-  this->num_agents_total = other_num_agents;
-  this->num_classes = other_num_classes;
-  this->iteration = other_iteration;
-  this->run_counter = other_run_counter;
-  this->time = other_time;
-  this->verbosity = other_verbosity;
-  this->initialized = other_initialized;
+  clearPointers();
+  moveFrom(other);
 }
 
 template <typename T>
 State<T>::State(int num_agents_total, int num_classes, int verbosity)
-  : num_agents_total(num_agents_total), num_classes(num_classes), 
-  verbosity(verbosity), iteration(0), run_counter(0), time(0),
-  positions(NULL), energy(NULL), energy_consumption_per_distance(NULL),
-  energy_consumption_per_time(NULL), energy_uptake_rate(NULL),
-  movespeed(NULL), sizes(NULL), status(NULL), class_id(NULL),
-  strategy(NULL), distances_agent_to_agent(NULL),
-  distances_agent_to_class(NULL), distances_class_to_class(NULL),
-  audibility(NULL), audibility_agent_to_class(NULL),
-  audibility_class_to_class(NULL), audibility_threshold(NULL),
+  : arena(NULL), arena_size(0), verbosity(verbosity),
+  num_agents_total(num_agents_total), num_classes(num_classes), pitch(0),
+  mask_pitch(0), iteration(0), run_counter(0), time(0),
+  initialized(false), positions(NULL), energy(NULL), movespeed(NULL),
+  sizes(NULL), status(NULL), class_id(NULL), strategy(NULL),
+  audibility_threshold(NULL), energy_consumption_per_time(NULL),
+  energy_consumption_per_distance(NULL), energy_uptake_rate(NULL),
+  distances_agent_to_agent(NULL), distances_agent_to_class(NULL),
+  distances_class_to_class(NULL), audibility(NULL),
+  audibility_agent_to_class(NULL), audibility_class_to_class(NULL),
   reachability(NULL), reachability_agent_to_class(NULL),
   reachability_class_to_class(NULL), contact(NULL),
   contact_agent_to_class(NULL), contact_class_to_class(NULL),
-  initialized(false)
+  hears_food(NULL)
 {
 #ifdef DEBUG
   std::cout << "State::State: \
@@ -239,232 +149,8 @@ State<T>& State<T>::operator=(State&& other)
 #endif
 
   // Move assignment operator
-  // The order of the following statements is important
   if (this != &other){
-
-    // Free memory
-    initialized = false;
-    this->num_agents_total = 0;
-    this->num_classes = 0;
-    this->iteration = 0;
-    this->run_counter = 0;
-    this->time = 0;
-    this->verbosity = 0;
-    freeMemory();
-
-    // Reset other
-    int other_num_agents = other.num_agents_total;
-    int other_num_classes = other.num_classes;
-    int other_iteration = other.iteration;
-    int other_run_counter = other.run_counter;
-    double other_time = other.time;
-    int other_verbosity = other.verbosity;
-    bool other_initialized = other.initialized;
-
-    other.num_agents_total = 0;
-    other.num_classes = 0;
-    other.iteration = 0;
-    other.run_counter = 0;
-    other.time = 0;
-    other.verbosity = 0;
-    other.initialized = false;
-
-    /* Move data */
-
-    // Distances agent to agent
-    if (other.distances_agent_to_agent != NULL) {
-      distances_agent_to_agent = other.distances_agent_to_agent;
-      other.distances_agent_to_agent = NULL;
-    } else{
-      distances_agent_to_agent = NULL;
-    }
-
-    // Audibility agent to agent
-    if (other.audibility != NULL) {
-      audibility = other.audibility;
-      other.audibility = NULL;
-    } else{
-      audibility = NULL;
-    }
-
-    // Reachability agent to agent
-    if (other.reachability != NULL) {
-      reachability = other.reachability;
-      other.reachability = NULL;
-    } else{
-      reachability = NULL;
-    }
-
-    // Contact agent to agent
-    if (other.contact != NULL) {
-      contact = other.contact;
-      other.contact = NULL;
-    } else{
-      contact = NULL;
-    }
-
-    // Distances agent to class
-    if (other.distances_agent_to_class != NULL) {
-      distances_agent_to_class = other.distances_agent_to_class;
-      other.distances_agent_to_class = NULL;
-    } else{
-      distances_agent_to_class = NULL;
-    }
-
-
-    // Audibility agent to class
-    if (other.audibility_agent_to_class != NULL) {
-      audibility_agent_to_class = other.audibility_agent_to_class;
-      other.audibility_agent_to_class = NULL;
-    } else{
-      audibility_agent_to_class = NULL;
-    }
-
-    // Reachability agent to class
-    if (other.reachability_agent_to_class != NULL) {
-      reachability_agent_to_class = other.reachability_agent_to_class;
-      other.reachability_agent_to_class = NULL;
-    } else{
-      reachability_agent_to_class = NULL;
-    }
-
-    
-    // Positions
-    if (other.positions != NULL) {
-      positions = other.positions;
-      other.positions = NULL;
-    } else{
-      positions = NULL;
-    }
-
-    // Energy
-    if (other.energy != NULL) {
-      energy = other.energy;
-      other.energy = NULL;
-    } else{
-      energy = NULL;
-    }
-
-    // Energy consumption per distance
-    if (other.energy_consumption_per_distance != NULL) {
-      energy_consumption_per_distance = other.energy_consumption_per_distance;
-      other.energy_consumption_per_distance = NULL;
-    } else{
-      energy_consumption_per_distance = NULL;
-    }
-
-    // Energy consumption per time
-    if (other.energy_consumption_per_time != NULL) {
-      energy_consumption_per_time = other.energy_consumption_per_time;
-      other.energy_consumption_per_time = NULL;
-    } else{
-      energy_consumption_per_time = NULL;
-    }
-
-    // Energy uptake rate
-    if (other.energy_uptake_rate != NULL) {
-      energy_uptake_rate = other.energy_uptake_rate;
-      other.energy_uptake_rate = NULL;
-    } else{
-      energy_uptake_rate = NULL;
-    }
-
-    // Sizes
-    if (other.sizes != NULL) {
-      sizes = other.sizes;
-      other.sizes = NULL;
-    } else{
-      sizes = NULL;
-    }
-
-    // Status
-    if (other.status != NULL) {
-      status = other.status;
-      other.status = NULL;
-    } else{
-      status = NULL;
-    }
-
-    // Class ID
-    if (other.class_id != NULL) {
-      class_id = other.class_id;
-      other.class_id = NULL;
-    } else{
-      class_id = NULL;
-    }
-
-    // Strategy
-    if (other.strategy != NULL) {
-      strategy = other.strategy;
-      other.strategy = NULL;
-    } else{
-      strategy = NULL;
-    }
-
-    // Movement speed
-    if (other.movespeed != NULL) {
-      movespeed = other.movespeed;
-      other.movespeed = NULL;
-    } else{
-      movespeed = NULL;
-    }
-
-    // Audibility threshold
-    if (other.audibility_threshold != NULL) {
-      audibility_threshold = other.audibility_threshold;
-      other.audibility_threshold = NULL;
-    } else{
-      audibility_threshold = NULL;
-    }
-
-    // Contact agent to class
-    if (other.contact_agent_to_class != NULL) {
-      contact_agent_to_class = other.contact_agent_to_class;
-      other.contact_agent_to_class = NULL;
-    } else{
-      contact_agent_to_class = NULL;
-    }
-    
-    // Distances class to class
-    if (other.distances_class_to_class != NULL) {
-      distances_class_to_class = other.distances_class_to_class;
-      other.distances_class_to_class = NULL;
-    } else{
-      distances_class_to_class = NULL;
-    }
-
-    // Audibility class to class
-    if (other.audibility_class_to_class != NULL) {
-      audibility_class_to_class = other.audibility_class_to_class;
-      other.audibility_class_to_class = NULL;
-    } else{
-      audibility_class_to_class = NULL;
-    }
-
-    // Reachability class to class
-    if (other.reachability_class_to_class != NULL) {
-      reachability_class_to_class = other.reachability_class_to_class;
-      other.reachability_class_to_class = NULL;
-    } else{
-      reachability_class_to_class = NULL;
-    }
-
-    // Contact class to class
-    if (other.contact_class_to_class != NULL) {
-      contact_class_to_class = other.contact_class_to_class;
-      other.contact_class_to_class = NULL;
-    } else{
-      contact_class_to_class = NULL;
-    }
-
-    // Set initialized flag
-    this->num_agents_total = other_num_agents;
-    this->num_classes = other_num_classes;
-    this->iteration = other_iteration;
-    this->run_counter = other_run_counter;
-    this->time = other_time;
-    this->verbosity = other_verbosity;
-    this->initialized = other_initialized;
+    moveFrom(other);
   }
   return *this;
 }
@@ -489,47 +175,154 @@ State<T>& State<T>::operator=(const State& other)
   this->verbosity = other.verbosity;
   this->initialized = other.initialized;
 
-  // Allocate memory
-  allocateMemory(num_agents_total, num_classes);
-
-  // Copy data
-  for (int i=0; i<num_agents_total; i++){
-    positions[i] = other.positions[i];
-    energy[i] = other.energy[i];
-    energy_consumption_per_distance[i] = 
-      other.energy_consumption_per_distance[i];
-    energy_consumption_per_time[i] = other.energy_consumption_per_time[i];
-    energy_uptake_rate[i] = other.energy_uptake_rate[i];
-    movespeed[i] = other.movespeed[i];
-    sizes[i] = other.sizes[i];
-    status[i] = other.status[i];
-    class_id[i] = other.class_id[i];
-    strategy[i] = other.strategy[i];
-    audibility_threshold[i] = other.audibility_threshold[i];
+  // Allocate memory, the layout of the arena only depends on the
+  // number of agents and classes, copy it as a whole
+  if (other.arena != NULL){
+    allocateMemory(num_agents_total, num_classes);
+    std::memcpy(arena, other.arena, arena_size);
   }
 
-  for (int i=0; i<num_agents_total*num_agents_total; i++){
-    distances_agent_to_agent[i] = other.distances_agent_to_agent[i];
-    audibility[i] = other.audibility[i];
-    reachability[i] = other.reachability[i];
-    contact[i] = other.contact[i];
-  }
+  return *this;
+}
+
+template <typename T>
+void State<T>::moveFrom(State &other)
+{
+  // Free memory
+  freeMemory();
 
-  for (int i=0; i<num_agents_total*num_classes; i++){
-    distances_agent_to_class[i] = other.distances_agent_to_class[i];
-    audibility_agent_to_class[i] = other.audibility_agent_to_class[i];
-    reachability_agent_to_class[i] = other.reachability_agent_to_class[i];
-    contact_agent_to_class[i] = other.contact_agent_to_class[i];
+  // Take the arena and the pointers into it
+  num_agents_total = other.num_agents_total;
+  num_classes = other.num_classes;
+  pitch = other.pitch;
+  mask_pitch = other.mask_pitch;
+  iteration = other.iteration;
+  run_counter = other.run_counter;
+  time = other.time;
+  verbosity = other.verbosity;
+  initialized = other.initialized;
+  arena = other.arena;
+  arena_size = other.arena_size;
+  if (arena != NULL){
+    layoutArena(num_agents_total, num_classes, arena);
   }
 
-  for (int i=0; i<num_classes*num_classes; i++){
-    distances_class_to_class[i] = other.distances_class_to_class[i];
-    audibility_class_to_class[i] = other.audibility_class_to_class[i];
-    reachability_class_to_class[i] = other.reachability_class_to_class[i];
-    contact_class_to_class[i] = other.contact_class_to_class[i];
+  // Reset other
+  other.arena = NULL;
+  other.arena_size = 0;
+  other.clearPointers();
+  other.num_agents_total = 0;
+  other.num_classes = 0;
+  other.pitch = 0;
+  other.mask_pitch = 0;
+  other.iteration = 0;
+  other.run_counter = 0;
+  other.time = 0;
+  other.verbosity = 0;
+  other.initialized = false;
+}
+
+template <typename T>
+size_t State<T>::layoutArena(int num_agents_total, int num_classes, 
+    char *base)
+{
+  // Row pitch in elements, every row of the matrices of distance_type, 
+  // T and int elements starts on a multiple of ROW_ALIGNMENT bytes, 
+  // threads writing adjacent rows do not share cache lines
+  int element_size = std::min(sizeof(distance_type), sizeof(int));
+  int step = ROW_ALIGNMENT / element_size;
+  pitch = (num_agents_total + step - 1) / step * step;
+
+  // If the pitch is a power of 2, add one step, avoids the rows 
+  // mapping to the same cache sets
+  while (isPowerOfTwo(pitch)){
+    pitch += step;
   }
 
-  return *this;
+  // Masks agent to agent are bit packed, rows are padded to whole
+  // cache lines
+  int words_per_line = ROW_ALIGNMENT / sizeof(uint64_t);
+  mask_pitch = (numWords(num_agents_total) + words_per_line - 1) 
+    / words_per_line * words_per_line;
+  size_t mask_words = (size_t)num_agents_total*mask_pitch;
+
+  // Sub-regions in the order of the previous separate allocations, 
+  // each starts on a cache line, only the offsets are computed if 
+  // base is NULL
+  size_t offset = 0;
+  auto carve = [&](size_t bytes) -> char * {
+    char *region = base != NULL ? base + offset : NULL;
+    offset += (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    return region;
+  };
+  size_t n = pitch;
+  size_t c = num_classes;
+
+  // Agent to agent, num_agents_total rows
+  distances_agent_to_agent = 
+    (distance_type *)carve(num_agents_total*n*sizeof(distance_type));
+  audibility = (uint64_t *)carve(mask_words*sizeof(uint64_t));
+  reachability = (uint64_t *)carve(mask_words*sizeof(uint64_t));
+  contact = (uint64_t *)carve(mask_words*sizeof(uint64_t));
+
+  // Hearing food, one bit packed row per class
+  hears_food = (uint64_t *)carve(c*mask_pitch*sizeof(uint64_t));
+
+  // Agent to class
+  distances_agent_to_class = (T *)carve(n*c*sizeof(T));
+  audibility_agent_to_class = (int *)carve(n*c*sizeof(int));
+  reachability_agent_to_class = (int *)carve(n*c*sizeof(int));
+  contact_agent_to_class = (int *)carve(n*c*sizeof(int));
+
+  // Agents, padded to the pitch for vector loads of the tails
+  positions = (Point3D<T> *)carve(n*sizeof(Point3D<T>));
+  energy = (T *)carve(n*sizeof(T));
+  energy_consumption_per_distance = (T *)carve(n*sizeof(T));
+  energy_consumption_per_time = (T *)carve(n*sizeof(T));
+  energy_uptake_rate = (T *)carve(n*sizeof(T));
+  sizes = (T *)carve(n*sizeof(T));
+  status = (int *)carve(n*sizeof(int));
+  class_id = (int *)carve(n*sizeof(int));
+  strategy = (int *)carve(n*sizeof(int));
+  movespeed = (T *)carve(n*sizeof(T));
+  audibility_threshold = (T *)carve(n*sizeof(T));
+
+  // Class to class
+  distances_class_to_class = (T *)carve(c*c*sizeof(T));
+  audibility_class_to_class = (int *)carve(c*c*sizeof(int));
+  reachability_class_to_class = (int *)carve(c*c*sizeof(int));
+  contact_class_to_class = (int *)carve(c*c*sizeof(int));
+
+  return offset;
+}
+
+template <typename T>
+void State<T>::clearPointers()
+{
+  positions = NULL;
+  energy = NULL;
+  energy_consumption_per_distance = NULL;
+  energy_consumption_per_time = NULL;
+  energy_uptake_rate = NULL;
+  movespeed = NULL;
+  sizes = NULL;
+  status = NULL;
+  class_id = NULL;
+  strategy = NULL;
+  distances_agent_to_agent = NULL;
+  distances_agent_to_class = NULL;
+  distances_class_to_class = NULL;
+  audibility = NULL;
+  audibility_agent_to_class = NULL;
+  audibility_class_to_class = NULL;
+  audibility_threshold = NULL;
+  reachability = NULL;
+  reachability_agent_to_class = NULL;
+  reachability_class_to_class = NULL;
+  contact = NULL;
+  contact_agent_to_class = NULL;
+  contact_class_to_class = NULL;
+  hears_food = NULL;
 }
 
 template <typename T>
@@ -551,122 +344,76 @@ void State<T>::allocateMemory(int num_agents_total, int num_classes)
   // Set the number of classes
   this->num_classes = num_classes;
 
-  // Alignment for SIMD compiler optimizations in bytes
-  size_t alignment = 16;
+  // One arena for all arrays, large arenas are aligned to huge pages
+  size_t size = layoutArena(num_agents_total, num_classes, NULL);
+  size_t alignment = ARENA_ALIGNMENT;
+#ifdef HUGE_PAGES
+  if (size >= HUGE_PAGE_SIZE){
+    alignment = HUGE_PAGE_SIZE;
+  }
+#endif
+  arena_size = (size + alignment - 1) & ~(alignment - 1);
+  arena = (char *)aligned_alloc(alignment, arena_size);
+  if (arena == NULL){
+    arena_size = 0;
+    handleError("State::allocateMemory: Allocation of the arena failed", 
+        CRITICAL);
+    return;
+  }
 
-  int size = num_agents_total;
+#ifdef HUGE_PAGES
+  // Ask for transparent huge pages, fewer TLB misses on the NxN sweeps
+  if (alignment == HUGE_PAGE_SIZE 
+      && madvise(arena, arena_size, MADV_HUGEPAGE) != 0){
+    handleError("State::allocateMemory: madvise(MADV_HUGEPAGE) failed", 
+        WARNING);
+  }
+#endif
 
-  // Pad size to be a multiple of alignment
-  size = (size + alignment - 1) & ~(alignment - 1);
+  // Sub-regions of the arena
+  layoutArena(num_agents_total, num_classes, arena);
 
-  // If size is a power of 2, add alignment
-  while (isPowerOfTwo(size)){
-    size += alignment;
-  }
+  // First touch, places the pages on the NUMA nodes of the threads
+  // which later sweep them
+  touchArena();
 
 #ifdef DEBUG
   if (verbosity > 4){
     std::cout << "State::allocateMemory: \
       num_agents_total: " << num_agents_total << std::endl;
     std::cout << "State::allocateMemory: \
-      Allocated memory size: " << size << std::endl;
+      Arena size: " << arena_size << " bytes" << std::endl;
   }
 #endif
+}
 
-  // Distances agent to agent
-  distances_agent_to_agent = 
-    (T *)aligned_alloc(alignment, size*size*sizeof(T));
-
-  // Audibility agent to agent
-  audibility = (int *)aligned_alloc(alignment, size*size*sizeof(int));
-
-  // Reachability agent to agent
-  reachability = (int *)aligned_alloc(alignment, size*size*sizeof(int));
-
-  // Contact agent to agent
-  contact = (int *)aligned_alloc(alignment, size*size*sizeof(int));
-
-  // Distances agent to class
-  distances_agent_to_class = 
-    (T *)aligned_alloc(alignment, size*num_classes*sizeof(T));
-
-  // Audibility agent to class
-  audibility_agent_to_class =
-    (int *)aligned_alloc(alignment, size*num_classes*sizeof(int));
-
-  // Reachability agent to class
-  reachability_agent_to_class =
-    (int *)aligned_alloc(alignment, size*num_classes*sizeof(int));
-
-  // Contact agent to class
-  contact_agent_to_class =
-    (int *)aligned_alloc(alignment, size*num_classes*sizeof(int));
-
-  // Positions
-  positions = 
-    (Point3D<T> *)aligned_alloc(alignment, size*sizeof(Point3D<T>));
-
-  // Energy
-  energy = (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Energy consumption per distance
-  energy_consumption_per_distance = 
-    (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Energy consumption per time
-  energy_consumption_per_time = 
-    (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Energy uptake rate
-  energy_uptake_rate = 
-    (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Sizes
-  sizes = (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Status
-  status = (int *)aligned_alloc(alignment, size*sizeof(int));
-
-  // Class ID 
-  class_id = (int *)aligned_alloc(alignment, size*sizeof(int));
-
-  // Strategy
-  strategy = (int *)aligned_alloc(alignment, size*sizeof(int));
-
-  // Movement speed
-  movespeed = 
-    (T *)aligned_alloc(alignment, size*sizeof(T));
-
-  // Audibility threshold
-  audibility_threshold = (T *)aligned_alloc(alignment, size*sizeof(T));
-
-
-  // Change padding size to fit the number of classes
-  // Pad size to be a multiple of alignment
-  size = num_classes;
-  size = (size + alignment - 1) & ~(alignment - 1);
-
-  // If size is a power of 2, add alignment
-  while (isPowerOfTwo(size)){
-    size += alignment;
+template <typename T>
+void State<T>::touchArena()
+{
+  // The agent to agent matrices come first in the arena, row i of each
+  // is zeroed by the thread which owns row i in the static schedule of
+  // the kernels
+  size_t row_bytes = (size_t)pitch*sizeof(distance_type);
+  size_t mask_row_bytes = (size_t)mask_pitch*sizeof(uint64_t);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < num_agents_total; i++){
+    std::memset((char *)distances_agent_to_agent + i*row_bytes, 0, 
+        row_bytes);
+    std::memset(audibility + (size_t)i*mask_pitch, 0, mask_row_bytes);
+    std::memset(reachability + (size_t)i*mask_pitch, 0, mask_row_bytes);
+    std::memset(contact + (size_t)i*mask_pitch, 0, mask_row_bytes);
   }
 
-  // Class to class distances
-  distances_class_to_class =
-    (T *)aligned_alloc(alignment, num_classes*num_classes*sizeof(T));
-
-  // Class to class audibility
-  audibility_class_to_class = 
-    (int *)aligned_alloc(alignment, num_classes*num_classes*sizeof(int));
-
-  // Class to class reachability
-  reachability_class_to_class = 
-    (int *)aligned_alloc(alignment, num_classes*num_classes*sizeof(int));
-
-  // Class to class contact
-  contact_class_to_class = 
-    (int *)aligned_alloc(alignment, num_classes*num_classes*sizeof(int));
-
+  // The remaining arrays follow the masks, zeroed in chunks
+  char *rest = (char *)hears_food;
+  size_t rest_bytes = arena + arena_size - rest;
+  size_t num_chunks = (rest_bytes + ARENA_TOUCH_CHUNK - 1) / ARENA_TOUCH_CHUNK;
+#pragma omp parallel for schedule(static)
+  for (size_t k = 0; k < num_chunks; k++){
+    size_t begin = k * ARENA_TOUCH_CHUNK;
+    size_t bytes = std::min((size_t)ARENA_TOUCH_CHUNK, rest_bytes - begin);
+    std::memset(rest + begin, 0, bytes);
+  }
 }
 
 template <typename T>
@@ -679,293 +426,13 @@ void State<T>::freeMemory()
   }
 #endif
 
-  /* Agent to agent variables */
-
-  // Distances agent to agent
-  if (distances_agent_to_agent != NULL) {
-    free(distances_agent_to_agent);
-    distances_agent_to_agent = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing distances agent to agent" << std::endl;
-    }
-#endif
+  // All arrays are sub-regions of the arena
+  if (arena != NULL) {
+    free(arena);
+    arena = NULL;
+    arena_size = 0;
   }
-
-  // Audibility agent to agent
-  if (audibility != NULL) {
-    free(audibility);
-    audibility = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing audibility" << std::endl;
-    }
-#endif
-  }
-
-  // Reachability agent to agent
-  if (reachability != NULL) {
-    free(reachability);
-    reachability = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing reachability" << std::endl;
-    }
-#endif
-  }
-
-  // Contact agent to agent
-  if (contact != NULL) {
-    free(contact);
-    contact = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing contact" << std::endl;
-    }
-#endif
-  }
-
-  /* Agent to class variables */
-
-  // Distances agent to class
-  if (distances_agent_to_class != NULL) {
-    free(distances_agent_to_class);
-    distances_agent_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing distances agent to class" << std::endl;
-    }
-#endif
-  }
-
-  // Audibility agent to class
-  if (audibility_agent_to_class != NULL) {
-    free(audibility_agent_to_class);
-    audibility_agent_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing audibility agent to class" << std::endl;
-    }
-#endif
-  }
-
-  // Reachability agent to class
-  if (reachability_agent_to_class != NULL) {
-    free(reachability_agent_to_class);
-    reachability_agent_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing reachability agent to class" << std::endl;
-    }
-#endif
-  }
-
-  // Contact agent to class
-  if (contact_agent_to_class != NULL) {
-    free(contact_agent_to_class);
-    contact_agent_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing contact agent to class" << std::endl;
-    }
-#endif
-  } 
-
-
-  /* Agent variables */
-
-  // Positions
-  if (positions != NULL) {
-    free(positions);
-    positions = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing positions" << std::endl;
-    }
-#endif
-  }
-
-  // Energy
-  if (energy != NULL) {
-    free(energy);
-    energy = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing energy" << std::endl;
-    }
-#endif
-  }
-
-  // Energy consumption per distance
-  if (energy_consumption_per_distance != NULL) {
-    free(energy_consumption_per_distance);
-    energy_consumption_per_distance = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing energy consumption per distance" << std::endl;
-    }
-#endif
-  }
-
-  // Energy consumption per time
-  if (energy_consumption_per_time != NULL) {
-    free(energy_consumption_per_time);
-    energy_consumption_per_time = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing energy consumption per time" << std::endl;
-    }
-#endif
-  }
-
-  // Energy uptake rate
-  if (energy_uptake_rate != NULL) {
-    free(energy_uptake_rate);
-    energy_uptake_rate = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing energy uptake rate" << std::endl;
-    }
-#endif
-  }
-
-  // Sizes
-  if (sizes != NULL) {
-    free(sizes);
-    sizes = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing sizes" << std::endl;
-    }
-#endif
-  }
-
-  // Status
-  if (status != NULL) {
-    free(status);
-    status = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing status" << std::endl;
-    }
-#endif
-  }
-
-  // Class ID
-  if (class_id != NULL) {
-    free(class_id);
-    class_id = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing class ID" << std::endl;
-    }
-#endif
-  } 
-
-  // Strategy
-  if (strategy != NULL) {
-    free(strategy);
-    strategy = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing strategy" << std::endl;
-    }
-#endif
-  }
-
-  // Movement speed
-  if (movespeed != NULL) {
-    free(movespeed);
-    movespeed = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing movement speed" << std::endl;
-    }
-#endif
-  }
-
-  // Audibility threshold
-  if (audibility_threshold != NULL) {
-    free(audibility_threshold);
-    audibility_threshold = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing audibility threshold" << std::endl;
-    }
-#endif
-  }
-
-
-
-  /* Class to class variables */
-
-  // Distances class to class
-  if (distances_class_to_class != NULL) {
-    free(distances_class_to_class);
-    distances_class_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing distances class to class" << std::endl;
-    }
-#endif
-  }
-
-  // Audibility class to class
-  if (audibility_class_to_class != NULL) {
-    free(audibility_class_to_class);
-    audibility_class_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing audibility class to class" << std::endl;
-    }
-#endif
-  }
-
-  // Reachability class to class
-  if (reachability_class_to_class != NULL) {
-    free(reachability_class_to_class);
-    reachability_class_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing reachability class to class" << std::endl;
-    }
-#endif
-  }
-
-  // Contact class to class
-  if (contact_class_to_class != NULL) {
-    free(contact_class_to_class);
-    contact_class_to_class = NULL;
-#ifdef DEBUG
-    if (verbosity > 6){
-      std::cout << "State::freeMemory: \
-        Freeing contact class to class" << std::endl;
-    }
-#endif
-  }
-
+  clearPointers();
 }
 
 template <typename T>
@@ -976,41 +443,26 @@ void State<T>::zeroMemory()
     Zeroing memory of the state" << std::endl;
 #endif
 
-  for (int i=0; i<num_agents_total; i++){
-    positions[i].setZero();
-    energy[i] = (T)0.0;
-    energy_consumption_per_distance[i] = (T)0.0;
-    energy_consumption_per_time[i] = (T)0.0;
-    energy_uptake_rate[i] = (T)0.0;
-    movespeed[i] = (T)0.0;
-    sizes[i] = (T)0.0;
-    status[i] = (T)0.0;
-    class_id[i] = (T)0.0;
-    strategy[i] = (T)0.0;
-    audibility_threshold[i] = (T)0.0;
-  }
-
-  for (int i=0; i<num_agents_total*num_agents_total; i++){
-    distances_agent_to_agent[i] = (T)0.0;
-    audibility[i] = (T)0.0;
-    reachability[i] = (T)0.0;
-    contact[i] = (T)0.0;
-  }
-
-  for (int i=0; i<num_agents_total*num_classes; i++){
-    distances_agent_to_class[i] = (T)0.0;
-    audibility_agent_to_class[i] = (T)0.0;
-    reachability_agent_to_class[i] = (T)0.0;
-    contact_agent_to_class[i] = (T)0.0;
-  }
-
-  for (int i=0; i<num_classes*num_classes; i++){
-    distances_class_to_class[i] = (T)0.0;
-    audibility_class_to_class[i] = (T)0.0;
-    reachability_class_to_class[i] = (T)0.0;
-    contact_class_to_class[i] = (T)0.0;
+  // Zero all arrays, the rows keep the threads of the first touch
+  if (arena != NULL){
+    touchArena();
   }
+}
 
+template <typename T>
+void State<T>::copyAgent(int from, int to)
+{
+  positions[to] = positions[from];
+  energy[to] = energy[from];
+  movespeed[to] = movespeed[from];
+  sizes[to] = sizes[from];
+  status[to] = status[from];
+  class_id[to] = class_id[from];
+  strategy[to] = strategy[from];
+  audibility_threshold[to] = audibility_threshold[from];
+  energy_consumption_per_time[to] = energy_consumption_per_time[from];
+  energy_consumption_per_distance[to] = energy_consumption_per_distance[from];
+  energy_uptake_rate[to] = energy_uptake_rate[from];
 }
 
 template <typename T>
@@ -1025,6 +477,19 @@ int State<T>::getNumAgentsTotal() const
   return num_agents_total;
 }
 
+template <typename T>
+int State<T>::getNumMaskWords() const
+{
+#ifdef DEBUG
+  std::cout << "State::getNumMaskWords: \
+    Number of words per mask row: " << numWords(num_agents_total) 
+    << std::endl;
+#endif
+
+  // Get the number of words of a row of the bit packed masks
+  return numWords(num_agents_total);
+}
+
 template <typename T>
 void State<T>::setNumAgentsTotal(int num_agents_total)
 {
@@ -1224,8 +689,8 @@ void State<T>::calculateDistances()
   // Calculate distances between individual agents
   for (int i=0; i<num_agents_total; i++){
     for (int j=0; j<num_agents_total; j++){
-      distances_agent_to_agent[i*num_agents_total+j] = 
-        positions[i].distance(positions[j]);
+      distances_agent_to_agent[i*pitch+j] = 
+        encodeDistance(positions[i].distance(positions[j]));
     }
   }
 }
@@ -1240,18 +705,18 @@ void State<T>::calculateAudibility()
   // i hears j = true 
 
   // Calculate audibility
+  int num_words = getNumMaskWords();
   for (int i=0; i<num_agents_total; i++){
+    uint64_t *row = &audibility[i*mask_pitch];
+    for (int w=0; w<num_words; w++){
+      row[w] = 0;
+    }
     for (int j=0; j<num_agents_total; j++){
-      if (distances_agent_to_agent[i*num_agents_total+j] 
-          < audibility_threshold[j]){
-        audibility[i*num_agents_total+j] = 1;
-      } else{
-        audibility[i*num_agents_total+j] = 0;
-      }
-      if (i == j){
-        audibility[i*num_agents_total+j] = 0;
+      if (getDistance(i, j) < audibility_threshold[j]){
+        setBit(row, j);
       }
     }
+    clearBit(row, i);
   }
 }
 
@@ -1264,17 +729,18 @@ void State<T>::calculateReachability()
 #endif
 
   // Calculate reachability
+  int num_words = getNumMaskWords();
   for (int i=0; i<num_agents_total; i++){
+    uint64_t *row = &reachability[i*mask_pitch];
+    for (int w=0; w<num_words; w++){
+      row[w] = 0;
+    }
     for (int j=0; j<num_agents_total; j++){
-      if (distances_agent_to_agent[i*num_agents_total+j] < movespeed[i]){
-        reachability[i*num_agents_total+j] = 1;
-      } else{
-        reachability[i*num_agents_total+j] = 0;
-      }
-      if (i == j){
-        reachability[i*num_agents_total+j] = 0;
+      if (getDistance(i, j) < movespeed[i]){
+        setBit(row, j);
       }
     }
+    clearBit(row, i);
   }
 }
 
@@ -1287,18 +753,18 @@ void State<T>::calculateContact()
 #endif
 
   // Calculate contact
+  int num_words = getNumMaskWords();
   for (int i=0; i<num_agents_total; i++){
+    uint64_t *row = &contact[i*mask_pitch];
+    for (int w=0; w<num_words; w++){
+      row[w] = 0;
+    }
     for (int j=0; j<num_agents_total; j++){
-      if (distances_agent_to_agent[i*num_agents_total+j] 
-          < 0.5 *(sizes[i]+sizes[j])){
-        contact[i*num_agents_total+j] = 1;
-      } else{
-        contact[i*num_agents_total+j] = 0;
-      }
-      if (i == j){
-        contact[i*num_agents_total+j] = 0;
+      if (getDistance(i, j) < 0.5 *(sizes[i]+sizes[j])){
+        setBit(row, j);
       }
     }
+    clearBit(row, i);
   }
 }
 
@@ -1333,7 +799,6 @@ void State<T>::calculateAverage(T* data, int start, int end, T& avg) const
   // Calculate average
   T sum = 0.0;
 //OMP_PLACEHOLDER
-#pragma omp for reduction(+:sum) num_threads(4)
   for (int i=start; i<end; i++){
     sum += data[i];
   }
@@ -1361,7 +826,6 @@ inline void State<T>::calculateSum(const int* data,
 
   // Calculate sum 
   sum = 0;
-#pragma omp for reduction(+:sum) num_threads(4) simd
   for (int i=start; i<end; i++){
     sum += data[i];
   }
@@ -1383,7 +847,6 @@ inline void State<T>::calculateSum(const T* data, const int& start, const int& e
 
   // Calculate sum 
   sum = 0.0;
-#pragma omp for reduction(+:sum) num_threads(4) simd
   for (int i=start; i<end; i++){
     sum += data[i];
   }
@@ -1484,10 +947,11 @@ void State<T>::printDistances(std::ostream &os,
   }
   
   // Print distances
-  int num_elements = num_agents_total*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << distances_agent_to_agent[i] << sep;
+  for (int i=0; i<num_agents_total; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << decodeDistance(distances_agent_to_agent[i*pitch + j]) << sep;
+    }
   }
   os << std::endl;
 }
@@ -1512,10 +976,11 @@ void State<T>::printDistancesAgentToClass(
   }
 
   // Print distances agent to class
-  int num_elements = num_classes*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << distances_agent_to_class[i] << sep;
+  for (int i=0; i<num_classes; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << distances_agent_to_class[i*pitch + j] << sep;
+    }
   }
   os << std::endl;
 }
@@ -1568,10 +1033,11 @@ void State<T>::printAudibility(std::ostream &os,
   }
 
   // Print audibility
-  int num_elements = num_agents_total*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << audibility[i] << sep;
+  for (int i=0; i<num_agents_total; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << testBit(&audibility[i*mask_pitch], j) << sep;
+    }
   }
   os << std::endl;
 }
@@ -1596,10 +1062,11 @@ void State<T>::printAudibilityAgentToClass(std::ostream &os, bool append,
   }
 
   // Print audibility agent to class
-  int num_elements = num_classes*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << audibility_agent_to_class[i] << sep;
+  for (int i=0; i<num_classes; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << audibility_agent_to_class[i*pitch + j] << sep;
+    }
   }
   os << std::endl;
 }
@@ -1652,10 +1119,11 @@ void State<T>::printReachability(std::ostream &os,
   }
 
   // Print reachability
-  int num_elements = num_agents_total*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << reachability[i] << sep;
+  for (int i=0; i<num_agents_total; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << testBit(&reachability[i*mask_pitch], j) << sep;
+    }
   }
   os << std::endl;
 }
@@ -1680,10 +1148,11 @@ void State<T>::printReachabilityAgentToClass(std::ostream &os, bool append,
   }
 
   // Print reachability agent to class
-  int num_elements = num_classes*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << reachability_agent_to_class[i] << sep;
+  for (int i=0; i<num_classes; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << reachability_agent_to_class[i*pitch + j] << sep;
+    }
   }
   os << std::endl;
 }
@@ -1736,10 +1205,11 @@ void State<T>::printContact(std::ostream &os,
   }
 
   // Print contact
-  int num_elements = num_agents_total*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << contact[i] << sep;
+  for (int i=0; i<num_agents_total; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << testBit(&contact[i*mask_pitch], j) << sep;
+    }
   }
   os << std::endl;
 }
@@ -1764,10 +1234,11 @@ void State<T>::printContactAgentToClass(std::ostream &os, bool append,
   }
 
   // Print contact agent to class
-  int num_elements = num_classes*num_agents_total;
   os << iteration << sep;
-  for (int i=0; i<num_elements; i++){
-    os << contact_agent_to_class[i] << sep;
+  for (int i=0; i<num_classes; i++){
+    for (int j=0; j<num_agents_total; j++){
+      os << contact_agent_to_class[i*pitch + j] << sep;
+    }
   }
   os << std::endl;
 }
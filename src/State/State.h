@@ -11,9 +11,38 @@
 #include "helpers.h"
 
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 #include <omp.h>
 
+#ifdef HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
+// All arrays of a state live in one arena, each starts on a cache line
+#define ARENA_ALIGNMENT 64
+
+// Rows of the agent to agent and agent to class matrices are padded to 
+// a multiple of this many bytes, one cache line or AVX-512 vector
+#define ROW_ALIGNMENT 64
+
+// Arenas of at least this size are aligned to huge pages if HUGE_PAGES 
+// is defined
+#define HUGE_PAGE_SIZE (2 << 20)
+
+// Bytes zeroed per task in the first touch of the arrays which are not
+// rows of the agent to agent matrices
+#define ARENA_TOUCH_CHUNK (1 << 16)
+
+#ifdef COMPACT_DISTANCES
+// Distances between agents are stored as 16 bit fixed point values.
+// The scaled world spans [-1, 1] in every dimension, its diagonal
+// maps to DISTANCE_FIXED_MAX.
+#define DISTANCE_FIXED_MAX 65534
+#define DISTANCE_FIXED_RANGE 3.4641016151377544
+#endif
 
 // Forward declaration of StateMachine
 template <typename T>
@@ -26,13 +55,19 @@ template <typename T>
 class AgentClass;
 
 template <typename T>
-class Search;
+class SearchState;
 
 template <typename T>
-class LevySearch;
+class StateHistory;
 
 template <typename T>
-class BrownianSearch;
+class NeighborLists;
+
+template <typename T>
+class ClassTree;
+
+template <typename T>
+class Population;
 
 template <typename T>
 struct State
@@ -61,13 +96,74 @@ struct State
   // Copy operator
   State& operator=(const State& other);
   
+  // Storage type of the distance matrix agent to agent
+#ifdef COMPACT_DISTANCES
+  typedef uint16_t distance_type;
+#else
+  typedef T distance_type;
+#endif
+
+  // Convert a distance to its stored representation and back,
+  // the order of distances is preserved
+  static distance_type encodeDistance(T d)
+  {
+#ifdef COMPACT_DISTANCES
+    T q = d * (T)(DISTANCE_FIXED_MAX / DISTANCE_FIXED_RANGE) + (T)0.5;
+    return (distance_type)std::min(q, (T)DISTANCE_FIXED_MAX);
+#else
+    return d;
+#endif
+  }
+
+  static T decodeDistance(distance_type d)
+  {
+#ifdef COMPACT_DISTANCES
+    return (T)d * (T)(DISTANCE_FIXED_RANGE / DISTANCE_FIXED_MAX);
+#else
+    return d;
+#endif
+  }
+
+  // Full precision distance between agents i and j, predicates are
+  // evaluated on this instead of the stored value
+  T getDistance(int i, int j) const
+  {
+#ifdef COMPACT_DISTANCES
+    return positions[i].distance(positions[j]);
+#else
+    return distances_agent_to_agent[i*pitch + j];
+#endif
+  }
+
+  // Number of elements of a padded row of the agent to agent and 
+  // agent to class matrices, row i starts at element i*getPitch()
+  int getPitch() const
+  {
+    return pitch;
+  }
+
+  // Number of 64 bit words of a padded row of the bit packed masks, 
+  // row i starts at word i*getMaskPitch()
+  int getMaskPitch() const
+  {
+    return mask_pitch;
+  }
+
   // Allocate/free memory for the state, fill with zeros
   void allocateMemory(int num_agents_total, int num_classes);
   void freeMemory();
   void zeroMemory();
 
+  // Copy the intrinsic properties of agent from to the slot to, the
+  // derived quantities are left to updateMeta
+  void copyAgent(int from, int to);
+
   // Get/set the number of agents
   int getNumAgentsTotal() const;
+
+  // Get the number of 64 bit words holding the bits of a row of the bit 
+  // packed masks, rows are padded to getMaskPitch() words
+  int getNumMaskWords() const;
   void setNumAgentsTotal(int num_agents_total);
 
   // Get/set the positions
@@ -246,6 +342,25 @@ struct State
 
  private:
 
+  // Memory of all arrays and its size in bytes
+  char *arena;
+  size_t arena_size;
+
+  // Set the pitches, point the arrays to their sub-regions of an arena 
+  // starting at base and return the size of the arena, only the size 
+  // if base is NULL
+  size_t layoutArena(int num_agents_total, int num_classes, char *base);
+
+  // Zero the arena in parallel, the rows of the agent to agent matrices
+  // by the threads which own them in the static schedule
+  void touchArena();
+
+  // Set all array pointers to NULL, does not free the arena
+  void clearPointers();
+
+  // Take the arena of other, leaves other empty
+  void moveFrom(State &other);
+
   // Verbosity level
   int verbosity;
 
@@ -255,6 +370,10 @@ struct State
   // Number of classes
   int num_classes;
 
+  // Padded row lengths, see getPitch and getMaskPitch
+  int pitch;
+  int mask_pitch;
+
   // Iteration counter
   int iteration;
 
@@ -308,11 +427,11 @@ struct State
 
   /* Derived variables */
 
-  // Distance matrix NxN 
-  // agent to agent
-  T *distances_agent_to_agent;
+  // Distance matrix NxN, rows of getPitch() elements
+  // agent to agent, see distance_type for the storage precision
+  distance_type *distances_agent_to_agent;
 
-  // Distance matrix #num_classesxN
+  // Distance matrix #num_classesxN, rows of getPitch() elements
   // agent to class average
   T *distances_agent_to_class;
 
@@ -320,33 +439,41 @@ struct State
   // class to class average
   T *distances_class_to_class;
 
-  // Audibility matrix NxN, agent to agent
-  int *audibility;
+  // Audibility matrix NxN, agent to agent, bit packed, row i starts at
+  // word i*getMaskPitch()
+  uint64_t *audibility;
   
-  // Sum of audibile agents of other classes
+  // Sum of audibile agents of other classes, rows of getPitch() elements
   int *audibility_agent_to_class;
 
   // Class audibility
   int *audibility_class_to_class;
 
-  // Reachability matrix NxN
-  int *reachability;
+  // Reachability matrix NxN, bit packed, row i starts at
+  // word i*getMaskPitch()
+  uint64_t *reachability;
 
-  // Sum of reachable agents of other classes
+  // Sum of reachable agents of other classes, rows of getPitch() elements
   int *reachability_agent_to_class;
 
   // Class reachability
   int *reachability_class_to_class;
 
-  // Contact matrix NxN
-  int *contact;
+  // Contact matrix NxN, bit packed, row i starts at
+  // word i*getMaskPitch()
+  uint64_t *contact;
 
-  // Sum of contact agents of other classes
+  // Sum of contact agents of other classes, rows of getPitch() elements
   int *contact_agent_to_class;
 
   // Class contact
   int *contact_class_to_class;
 
+  // Hearing food, bit packed, bit j of row c is set if agent j hears 
+  // at least one food source class of class c, 
+  // rows of getMaskPitch() words
+  uint64_t *hears_food;
+
 
   // Lock
 #ifdef ANIMATION
@@ -358,8 +485,11 @@ struct State
   friend class StateMachine<T>;
   friend class Agent<T>;
   friend class AgentClass<T>;
-  friend class Search<T>;
-  friend class LevySearch<T>;
+  friend class SearchState<T>;
+  friend class StateHistory<T>;
+  friend class NeighborLists<T>;
+  friend class ClassTree<T>;
+  friend class Population<T>;
 
 };
 
@@ -0,0 +1,138 @@
+#include "StateHistory.h"
+
+template <typename T>
+StateHistory<T>::StateHistory()
+  : capacity(0), head(-1), count(0)
+{
+#ifdef DEBUG
+  std::cout << "StateHistory::StateHistory: Constructor" << std::endl;
+#endif
+}
+
+template <typename T>
+StateHistory<T>::~StateHistory()
+{
+#ifdef DEBUG
+  std::cout << "StateHistory::~StateHistory: Destructor" << std::endl;
+#endif
+}
+
+template <typename T>
+void StateHistory<T>::init(int capacity)
+{
+#ifdef DEBUG
+  std::cout << "StateHistory::init: \
+    Keeping " << capacity << " entries" << std::endl;
+#endif
+  this->capacity = capacity > 0 ? capacity : 0;
+  entries.clear();
+  entries.resize(this->capacity);
+  head = -1;
+  count = 0;
+}
+
+template <typename T>
+int StateHistory<T>::size() const
+{
+  return count;
+}
+
+template <typename T>
+void StateHistory<T>::push(const State<T> &older, const State<T> &newer)
+{
+  if (capacity == 0){
+    return;
+  }
+
+  // Reuse the oldest entry, keeps the capacity of its vectors
+  head = (head + 1) % capacity;
+  if (count < capacity){
+    count++;
+  }
+  Entry &e = entries[head];
+  e.iteration = older.iteration;
+  e.time = older.time;
+  e.position_ids.clear();
+  e.positions.clear();
+  e.energy_ids.clear();
+  e.energy.clear();
+  e.status_ids.clear();
+  e.status.clear();
+
+  // Keep the old values of the agents which changed in this step
+  for (int i = 0; i < older.num_agents_total; i++){
+    const Point3D<T> &p = older.positions[i];
+    const Point3D<T> &q = newer.positions[i];
+    if (p.x != q.x || p.y != q.y || p.z != q.z){
+      e.position_ids.push_back(i);
+      e.positions.push_back(p);
+    }
+    if (older.energy[i] != newer.energy[i]){
+      e.energy_ids.push_back(i);
+      e.energy.push_back(older.energy[i]);
+    }
+    if (older.status[i] != newer.status[i]){
+      e.status_ids.push_back(i);
+      e.status.push_back(older.status[i]);
+    }
+  }
+}
+
+template <typename T>
+void StateHistory<T>::restore(int k, const State<T> &newest,
+    State<T> &state) const
+{
+#ifdef DEBUG
+  std::cout << "StateHistory::restore: \
+    Restoring entry " << k << std::endl;
+#endif
+  if (k < 0 || k >= count){
+    handleError("StateHistory::restore: Entry not in the history",
+        WARNING);
+    return;
+  }
+
+  // Start from the agent variables of the newest state
+  int n = newest.num_agents_total;
+  state.allocateMemory(n, newest.num_classes);
+  for (int i = 0; i < n; i++){
+    state.positions[i] = newest.positions[i];
+    state.energy[i] = newest.energy[i];
+    state.energy_consumption_per_distance[i] =
+      newest.energy_consumption_per_distance[i];
+    state.energy_consumption_per_time[i] =
+      newest.energy_consumption_per_time[i];
+    state.energy_uptake_rate[i] = newest.energy_uptake_rate[i];
+    state.movespeed[i] = newest.movespeed[i];
+    state.sizes[i] = newest.sizes[i];
+    state.status[i] = newest.status[i];
+    state.class_id[i] = newest.class_id[i];
+    state.strategy[i] = newest.strategy[i];
+    state.audibility_threshold[i] = newest.audibility_threshold[i];
+  }
+
+  // Undo the steps from the most recent entry to entry k
+  for (int j = 0; j <= k; j++){
+    const Entry &e = entries[(head - j + capacity) % capacity];
+    for (int m = 0; m < (int)e.position_ids.size(); m++){
+      state.positions[e.position_ids[m]] = e.positions[m];
+    }
+    for (int m = 0; m < (int)e.energy_ids.size(); m++){
+      state.energy[e.energy_ids[m]] = e.energy[m];
+    }
+    for (int m = 0; m < (int)e.status_ids.size(); m++){
+      state.status[e.status_ids[m]] = e.status[m];
+    }
+    state.iteration = e.iteration;
+    state.time = e.time;
+  }
+  state.run_counter = newest.run_counter;
+  state.verbosity = newest.verbosity;
+  state.initialized = true;
+}
+
+// Explicit instantiation
+template class StateHistory<float>;
+template class StateHistory<double>;
+
+/* vim: set ts=2 sw=2 tw=0 et :*/
@@ -0,0 +1,66 @@
+#ifndef STATEHISTORY_H
+#define STATEHISTORY_H
+
+#include <vector>
+#include "Point3D.h"
+#include "State.h"
+
+/*
+ * History of the states older than the two full states of the state
+ * machine. Each entry is an undo record of one step: the iteration and
+ * time of the older state and the positions, energies and status of the
+ * agents which changed in that step. Derived quantities are not kept,
+ * restore recomputes nothing, call updateMeta on the restored state if
+ * they are needed. The memory scales with the number of agents, not
+ * with its square.
+ */
+template <typename T>
+class StateHistory
+{
+ public:
+
+  // Constructor
+  StateHistory();
+
+  // Destructor
+  ~StateHistory();
+
+  // Keep at most capacity entries, clears the history
+  void init(int capacity);
+
+  // Number of entries
+  int size() const;
+
+  // Record the step from older to newer as the most recent entry, the
+  // oldest entry is dropped if the history is full
+  void push(const State<T> &older, const State<T> &newer);
+
+  // Restore entry k, 0 is the most recent one, by undoing the steps
+  // starting from newest, the state older was recorded against; the
+  // derived quantities of state are zero
+  void restore(int k, const State<T> &newest, State<T> &state) const;
+
+ private:
+
+  // Undo record of one step
+  struct Entry
+  {
+    int iteration;
+    double time;
+    std::vector<int> position_ids;
+    std::vector<Point3D<T>> positions;
+    std::vector<int> energy_ids;
+    std::vector<T> energy;
+    std::vector<int> status_ids;
+    std::vector<int> status;
+  };
+
+  // Ring buffer of the entries, head is the most recent one
+  std::vector<Entry> entries;
+  int capacity;
+  int head;
+  int count;
+};
+
+#endif // STATEHISTORY_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
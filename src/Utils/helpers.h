@@ -8,6 +8,7 @@
 #include <limits>
 #include <typeinfo>
 #include <iostream>
+#include <cstdint>
 
 #ifdef ANIMATION
 #include <omp.h>
@@ -104,6 +105,70 @@ bool static isPowerOfTwo(int x)
   return (x & (x - 1)) == 0;
 }
 
+// Bitsets are stored in 64 bit words, bit j of a row is bit j%64 of
+// word j/64
+#define BITS_PER_WORD 64
+
+// Number of words of a bitset with n bits
+int static numWords(int n)
+{
+  return (n + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+// Test bit j of a bitset
+bool static testBit(const uint64_t *bits, int j)
+{
+  return (bits[j / BITS_PER_WORD] >> (j % BITS_PER_WORD)) & 1;
+}
+
+// Set bit j of a bitset
+void static setBit(uint64_t *bits, int j)
+{
+  bits[j / BITS_PER_WORD] |= (uint64_t)1 << (j % BITS_PER_WORD);
+}
+
+// Clear bit j of a bitset
+void static clearBit(uint64_t *bits, int j)
+{
+  bits[j / BITS_PER_WORD] &= ~((uint64_t)1 << (j % BITS_PER_WORD));
+}
+
+// Set bit j of a bitset to value
+void static assignBit(uint64_t *bits, int j, bool value)
+{
+  const uint64_t bit = (uint64_t)1 << (j % BITS_PER_WORD);
+  bits[j / BITS_PER_WORD] = (bits[j / BITS_PER_WORD] & ~bit) 
+    | ((uint64_t)value << (j % BITS_PER_WORD));
+}
+
+// Mask selecting the bits of word w which lie in the range [start, stop)
+uint64_t static maskWordRange(int w, int start, int stop)
+{
+  uint64_t m = ~(uint64_t)0;
+  int lo = start - w * BITS_PER_WORD;
+  int hi = stop - w * BITS_PER_WORD;
+  if (lo > 0){
+    m &= ~(uint64_t)0 << lo;
+  }
+  if (hi < BITS_PER_WORD){
+    m &= ((uint64_t)1 << hi) - 1;
+  }
+  return m;
+}
+
+// Count the set bits of a bitset in the range [start, stop)
+int static countBits(const uint64_t *bits, int start, int stop)
+{
+  int count = 0;
+  if (stop <= start){
+    return 0;
+  }
+  for (int w = start / BITS_PER_WORD; w <= (stop - 1) / BITS_PER_WORD; w++){
+    count += __builtin_popcountll(bits[w] & maskWordRange(w, start, stop));
+  }
+  return count;
+}
+
 // Function template to print an array
 template <typename T>
 void static printArray(const T *array, int n, int m)
@@ -0,0 +1,189 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "helpers.h"
+
+// NUMA nodes are read from sysfs, node<k>/cpulist lists the cpus of node k
+#define SYSFS_NODE_DIR "/sys/devices/system/node"
+
+// Nodes probed in sysfs
+#define MAX_NUMA_NODES 64
+
+// Name of an OpenMP binding policy
+std::string static procBindString(omp_proc_bind_t bind)
+{
+  switch (bind) {
+    case omp_proc_bind_false:
+      return "false";
+    case omp_proc_bind_true:
+      return "true";
+    case omp_proc_bind_primary:
+      return "primary (former master)";
+    case omp_proc_bind_close:
+      return "close";
+    case omp_proc_bind_spread:
+      return "spread";
+    default:
+      return "unknown";
+  }
+}
+
+// Cpu ids of a sysfs cpu list, e.g. "0-3,8-11"
+std::vector<int> static parseCpuList(const std::string &list)
+{
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')){
+    if (range.empty() || range == "\n"){
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last = dash == std::string::npos ?
+      first : std::atoi(range.substr(dash + 1).c_str());
+    for (int c = first; c <= last; c++){
+      cpus.push_back(c);
+    }
+  }
+  return cpus;
+}
+
+// NUMA node of every cpu, -1 if unknown, sets the number of nodes,
+// 0 if sysfs lists none
+std::vector<int> static readNumaNodes(int &num_nodes)
+{
+  std::vector<int> node_of_cpu;
+  num_nodes = 0;
+  for (int k = 0; k < MAX_NUMA_NODES; k++){
+    std::ifstream file(std::string(SYSFS_NODE_DIR) + "/node"
+        + std::to_string(k) + "/cpulist");
+    if (!file.is_open()){
+      continue;
+    }
+    std::string list;
+    std::getline(file, list);
+    for (int c : parseCpuList(list)){
+      if (c >= (int)node_of_cpu.size()){
+        node_of_cpu.resize(c + 1, -1);
+      }
+      node_of_cpu[c] = k;
+    }
+    num_nodes++;
+  }
+  return node_of_cpu;
+}
+
+// Placement of one OpenMP thread
+struct ThreadPlacement
+{
+  int place;
+  int cpu;
+  int node;
+};
+
+// Placement of the threads of a parallel region with the current
+// number of threads, cpu and node are -1 if unknown
+std::vector<ThreadPlacement> static getThreadPlacement(
+    const std::vector<int> &node_of_cpu)
+{
+  std::vector<ThreadPlacement> placement(omp_get_max_threads());
+#pragma omp parallel
+  {
+    ThreadPlacement p;
+    p.place = omp_get_place_num();
+#ifdef __linux__
+    p.cpu = sched_getcpu();
+#else
+    p.cpu = -1;
+#endif
+    p.node = (p.cpu >= 0 && p.cpu < (int)node_of_cpu.size()) ?
+      node_of_cpu[p.cpu] : -1;
+    placement[omp_get_thread_num()] = p;
+  }
+  return placement;
+}
+
+// Print the processors, NUMA nodes, the OpenMP affinity settings and
+// the effective placement of the threads
+void static printTopology(std::ostream &os = std::cout)
+{
+  int num_nodes;
+  std::vector<int> node_of_cpu = readNumaNodes(num_nodes);
+  const char *places = std::getenv("OMP_PLACES");
+  const char *bind = std::getenv("OMP_PROC_BIND");
+
+  os << "Processors:\t" << omp_get_num_procs() << std::endl;
+  os << "NUMA nodes:\t" << num_nodes << std::endl;
+  os << "OMP_PLACES:\t" << (places ? places : "(unset)") << std::endl;
+  os << "OMP_PROC_BIND:\t" << (bind ? bind : "(unset)") << std::endl;
+  os << "Binding policy:\t" << procBindString(omp_get_proc_bind())
+    << std::endl;
+  os << "Places:\t\t" << omp_get_num_places() << std::endl;
+  os << "Threads:\t" << omp_get_max_threads() << std::endl;
+
+  std::vector<ThreadPlacement> placement = getThreadPlacement(node_of_cpu);
+  for (int t = 0; t < (int)placement.size(); t++){
+    os << "  thread " << t
+      << "\tplace " << placement[t].place
+      << "\tcpu " << placement[t].cpu
+      << "\tnode " << placement[t].node << std::endl;
+  }
+}
+
+// Check the affinity settings, warns if the threads are not bound on a
+// machine with several NUMA nodes, the first touch placement of the
+// state rows is lost when threads migrate, if the threads oversubscribe
+// the processors or if they all run on one of several nodes
+void static checkAffinity()
+{
+  int num_nodes;
+  std::vector<int> node_of_cpu = readNumaNodes(num_nodes);
+  int num_threads = omp_get_max_threads();
+
+  if (std::getenv("OMP_PLACES") != NULL && omp_get_num_places() == 0){
+    handleError("checkAffinity: OMP_PLACES was not understood", WARNING);
+  }
+
+  if (num_threads > omp_get_num_procs()){
+    handleError("checkAffinity: More threads than processors", WARNING);
+  }
+
+  if (num_nodes < 2 || num_threads < 2){
+    return;
+  }
+
+  if (omp_get_proc_bind() == omp_proc_bind_false){
+    handleError("checkAffinity: Threads are not bound on a machine with "
+        + std::to_string(num_nodes) + " NUMA nodes, set OMP_PROC_BIND, "
+        "see setenv.sh", WARNING);
+    return;
+  }
+
+  std::vector<ThreadPlacement> placement = getThreadPlacement(node_of_cpu);
+  bool one_node = true;
+  for (const ThreadPlacement &p : placement){
+    one_node = one_node && p.node == placement[0].node;
+  }
+  if (one_node && placement[0].node >= 0){
+    handleError("checkAffinity: All threads run on NUMA node "
+        + std::to_string(placement[0].node) + " of "
+        + std::to_string(num_nodes) + ", OMP_PROC_BIND=spread uses the "
+        "memory bandwidth of all nodes", WARNING);
+  }
+}
+
+#endif // TOPOLOGY_H
+/* vim: set ts=2 sw=2 tw=0 et :*/
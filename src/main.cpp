@@ -7,6 +7,7 @@
 #include "GlobalParameters.h"
 #include "AnimationParameters.h"
 #include "Simulation.h"
+#include "topology.h"
 
 #define IN_LINE true
 #ifdef PAPI_LL
@@ -29,23 +30,6 @@ void handle_papi_error(int retval) {
 // Animation only supports float
 #define TYPE float 
 
-std::string get_omp_proc_bind_string(omp_proc_bind_t bind) {
-  switch (bind) {
-    case omp_proc_bind_false:
-      return "false";
-    case omp_proc_bind_true:
-      return "true";
-    case omp_proc_bind_primary:
-      return "primary (former master)";
-    case omp_proc_bind_close:
-      return "close";
-    case omp_proc_bind_spread:
-      return "spread";
-    default:
-      return "unknown";
-  }
-}
-       
 int main(int argc, char **argv) {
 
   /* INITIALIZATION */
@@ -65,6 +49,10 @@ int main(int argc, char **argv) {
 #ifdef DEBUG
   std::cout << "Number of threads used:\t"<<omp_get_max_threads()<<std::endl;
 #endif //DEBUG
+
+  // Check the affinity settings, the rows of the states are first
+  // touched by the threads which use them
+  checkAffinity();
 #endif //PARALLEL
 
 #ifdef ANIMATION
@@ -96,6 +84,13 @@ int main(int argc, char **argv) {
       simulation_parameters);
   simulation_parameters.countAgents();
 
+#ifdef PARALLEL
+  // Print the placement of the threads
+  if (global_parameters.getVerbosity() > 1){
+    printTopology();
+  }
+#endif //PARALLEL
+
   /* Initialize state machine*/
   std::random_device rd;
   StateMachine<TYPE> state_machine(rd, global_parameters);
@@ -133,7 +128,7 @@ int main(int argc, char **argv) {
         Animation<TYPE> animation(simulation, state_machine, global_parameters);
 #ifdef DEBUG
         omp_proc_bind_t bind = omp_get_proc_bind();
-        std::string bind_str = get_omp_proc_bind_string(bind);
+        std::string bind_str = procBindString(bind);
         std::cout << "Animation thread binding policy: " 
           << bind_str << std::endl;
 #endif
@@ -143,7 +138,7 @@ int main(int argc, char **argv) {
       {
 #ifdef DEBUG
         omp_proc_bind_t bind = omp_get_proc_bind();
-        std::string bind_str = get_omp_proc_bind_string(bind);
+        std::string bind_str = procBindString(bind);
         std::cout << "Simulation thread binding policy: " 
           << bind_str << std::endl;
 #endif
@@ -158,8 +153,12 @@ int main(int argc, char **argv) {
 
 
   /* Headless simulation */
-  // Run the simulation
-  simulation.runHeadless();
+  // Run the scaling study or the simulation
+  if (global_parameters.getScalingStudyFlag()) {
+    simulation.runScalingStudy();
+  } else {
+    simulation.runHeadless();
+  }
 
   /* Stop PAPI measurements */
 #ifdef PAPI_LL